@@ -0,0 +1,364 @@
+/**
+ * @file ma_spansion_s25fl1xxk_benchmark.c
+ *
+ * @brief Host throughput/latency benchmark for the Spansion S25FL1xxk driver.
+ * The driver is built with the host simulator port and driven through a real
+ * FreeRTOS+FAT IOManager (FreeRTOS POSIX port). All times are measured on the
+ * virtual clock of the simulator, i.e. SPI bus time plus device busy time.
+ *
+ * Build (FreeRTOS kernel POSIX port and FreeRTOS+FAT sources are needed):
+ *   gcc -DspansionSPI_PORT=spansionSPI_PORT_HOST_SIMULATOR
+ *       -I<driver>/include -I<driver> -I<FreeRTOS+FAT>/include -I<FreeRTOS>/include
+ *       -I<FreeRTOS>/portable/ThirdParty/GCC/Posix -I<config dir>
+ *       <driver>/ma_spansion_s25flxxk.c <driver>/benchmark/ma_spansion_s25fl1xxk_benchmark.c
+ *       <FreeRTOS+FAT sources> <FreeRTOS kernel sources> -lpthread -o spansion_benchmark
+ *
+ * Usage: spansion_benchmark [-f backing_file] [-s file_size_KiB] [-c spi_clock_Hz] [-t trace_file]
+ *   -t writes the binary trace events of the disk (spansion_trace_event_t), decode them with
+ *      tools/ma_spansion_s25fl1xxk_trace_decode.c.
+ *
+ * @author Lovas Szilárd <lovas.szilard@gmail.com>
+ * @version: 0.3
+ * @date: 2017-06-12 10:00
+ * - initial version
+ * @date: 2017-07-10 10:00
+ * - 0.2 Simulator API with chip index (chip 0).
+ * @date: 2017-07-31 10:00
+ * - 0.3 The trace file gets the drained binary trace ring instead of the vLoggingPrintf() lines.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* FreeRTOS+FAT includes. */
+#include "ff_headers.h"
+#include "ff_stdio.h"
+
+#include "ma_spansion_s25fl1xxk.h"
+#include "ma_spansion_s25fl1xxk_simulator.h"
+
+#define benchDISK_NAME				"/spi"
+#define benchCHUNK_SIZE				4096
+#define benchDEFAULT_FILE_SIZE_KIB	256
+#define benchSMALL_FILE_COUNT		64
+#define benchSMALL_FILE_SIZE		1024
+#define benchTASK_STACK_SIZE		(configMINIMAL_STACK_SIZE * 8)
+#define benchTRACE_DRAIN_EVENTS		64
+#define benchTRACE_DRAIN_PERIOD_MS	10
+
+typedef struct {
+	const char			*pcName;
+	uint64_t			ullStart;				/* Virtual time at the start [us]. */
+	spansion_sim_stats_t	xStats;				/* Simulator counters at the start. */
+} bench_measurement_t;
+
+static const char *pcBackingFile = NULL;
+static uint32_t ulFileSize = benchDEFAULT_FILE_SIZE_KIB * 1024;
+static uint32_t ulSpiClock = spansionSIM_SPI_CLOCK_HZ;
+static FILE *pxTraceFile = NULL;
+static FF_Disk_t * volatile pxBenchDisk = NULL;
+static uint8_t ucChunk[benchCHUNK_SIZE];
+
+static void prvBenchmarkTask(void *pvParameters);
+static void prvTraceTask(void *pvParameters);
+static void prvTraceDrain(void);
+static void prvMeasureStart(bench_measurement_t *pxMeasurement, const char *pcName);
+static void prvMeasureEnd(bench_measurement_t *pxMeasurement, uint32_t ulBytes);
+static void prvSync(FF_Disk_t *pxDisk);
+static BaseType_t prvWriteFile(const char *pcPath, const char *pcMode, uint32_t ulSize, uint8_t ucSeed);
+static BaseType_t prvReadFile(const char *pcPath, uint32_t ulSize);
+static void prvFillChunk(uint32_t ulOffset, uint8_t ucSeed);
+
+/**
+ * @fn void vLoggingPrintf(const char *pcFormat, ...)
+ * @brief Sink of the FreeRTOS+FAT messages (stderr).
+ */
+void vLoggingPrintf(const char *pcFormat, ...)
+{
+	va_list xArgs;
+
+	va_start(xArgs, pcFormat);
+	vfprintf(stderr, pcFormat, xArgs);
+	va_end(xArgs);
+}
+
+int main(int argc, char **argv)
+{
+	int iOption;
+
+	while((iOption = getopt(argc, argv, "f:s:c:t:")) != -1)
+	{
+		switch(iOption)
+		{
+			case 'f':
+				pcBackingFile = optarg;
+				break;
+			case 's':
+				ulFileSize = (uint32_t)strtoul(optarg, NULL, 0) * 1024;
+				break;
+			case 'c':
+				ulSpiClock = (uint32_t)strtoul(optarg, NULL, 0);
+				break;
+			case 't':
+				pxTraceFile = fopen(optarg, "wb");
+				break;
+			default:
+				fprintf(stderr, "usage: %s [-f backing_file] [-s file_size_KiB] [-c spi_clock_Hz] [-t trace_file]\n", argv[0]);
+				return(EXIT_FAILURE);
+		}
+	}
+
+	if(xSpansionSim_Open(0, pcBackingFile) != pdPASS)
+	{
+		fprintf(stderr, "Can not open the flash backing store.\n");
+		return(EXIT_FAILURE);
+	}
+	vSpansionSim_SetSpiClock(ulSpiClock);
+
+	xTaskCreate(prvBenchmarkTask, "bench", benchTASK_STACK_SIZE, NULL, tskIDLE_PRIORITY + 1, NULL);
+	if(pxTraceFile != NULL)
+	{
+		xTaskCreate(prvTraceTask, "trace", benchTASK_STACK_SIZE, NULL, tskIDLE_PRIORITY + 2, NULL);
+	}
+	vTaskStartScheduler();
+
+	return(EXIT_FAILURE);
+}
+
+/**
+ * @fn static void prvBenchmarkTask(void *pvParameters)
+ * @brief Formats the emulated disk and runs the workloads.
+ */
+static void prvBenchmarkTask(void *pvParameters)
+{
+	FF_Disk_t *pxDisk;
+	bench_measurement_t xMeasurement;
+	char cPath[32];
+	uint32_t i;
+
+	(void)pvParameters;
+
+	printf("workload,bytes,time_ms,KiB/s,spi_clocks,read_bytes,page_programs,sector_erases,block_erases,busy_ms\n");
+
+	prvMeasureStart(&xMeasurement, "format");
+	pxDisk = FF_SPIDiskInit(benchDISK_NAME, pdTRUE);
+	if(pxDisk == NULL)
+	{
+		fprintf(stderr, "FF_SPIDiskInit failed.\n");
+		exit(EXIT_FAILURE);
+	}
+	pxBenchDisk = pxDisk;
+	prvSync(pxDisk);
+	prvMeasureEnd(&xMeasurement, 0);
+
+	/* Clean write: new file on erased clusters. */
+	prvMeasureStart(&xMeasurement, "clean-write");
+	prvWriteFile(benchDISK_NAME "/stream.bin", "w", ulFileSize, 0x5a);
+	prvSync(pxDisk);
+	prvMeasureEnd(&xMeasurement, ulFileSize);
+
+	/* Dirty write with the same content. */
+	prvMeasureStart(&xMeasurement, "same-write");
+	prvWriteFile(benchDISK_NAME "/stream.bin", "r+", ulFileSize, 0x5a);
+	prvSync(pxDisk);
+	prvMeasureEnd(&xMeasurement, ulFileSize);
+
+	/* Dirty write with different content: erase is needed. */
+	prvMeasureStart(&xMeasurement, "dirty-write");
+	prvWriteFile(benchDISK_NAME "/stream.bin", "r+", ulFileSize, 0xa5);
+	prvSync(pxDisk);
+	prvMeasureEnd(&xMeasurement, ulFileSize);
+
+	/* Sequential read. */
+	prvMeasureStart(&xMeasurement, "sequential-read");
+	prvReadFile(benchDISK_NAME "/stream.bin", ulFileSize);
+	prvMeasureEnd(&xMeasurement, ulFileSize);
+
+	/* FAT heavy: many small files created and deleted in a directory. */
+	prvMeasureStart(&xMeasurement, "fat-heavy");
+	ff_mkdir(benchDISK_NAME "/small");
+	for(i = 0; i < benchSMALL_FILE_COUNT; i++)
+	{
+		snprintf(cPath, sizeof(cPath), benchDISK_NAME "/small/f%03u.bin", (unsigned)i);
+		prvWriteFile(cPath, "w", benchSMALL_FILE_SIZE, (uint8_t)i);
+	}
+	for(i = 0; i < benchSMALL_FILE_COUNT; i++)
+	{
+		snprintf(cPath, sizeof(cPath), benchDISK_NAME "/small/f%03u.bin", (unsigned)i);
+		ff_remove(cPath);
+	}
+	prvSync(pxDisk);
+	prvMeasureEnd(&xMeasurement, benchSMALL_FILE_COUNT * benchSMALL_FILE_SIZE);
+
+	if(pxTraceFile != NULL)
+	{
+		vTaskSuspendAll();
+		prvTraceDrain();
+		fclose(pxTraceFile);
+	}
+	vSpansionSim_Close(0);
+	exit(EXIT_SUCCESS);
+}
+
+/**
+ * @fn static void prvTraceTask(void *pvParameters)
+ * @brief Drains the trace ring of the disk periodically, so the ring doesn't overflow.
+ */
+static void prvTraceTask(void *pvParameters)
+{
+	(void)pvParameters;
+
+	for(;;)
+	{
+		prvTraceDrain();
+		vTaskDelay(pdMS_TO_TICKS(benchTRACE_DRAIN_PERIOD_MS));
+	}
+}
+
+/**
+ * @fn static void prvTraceDrain(void)
+ * @brief Writes the events of the trace ring to the trace file.
+ */
+static void prvTraceDrain(void)
+{
+	spansion_trace_event_t xEvents[benchTRACE_DRAIN_EVENTS];
+	UBaseType_t uxCount;
+
+	if(pxBenchDisk == NULL)
+	{
+		return;
+	}
+	do
+	{
+		uxCount = uxSpansionSPI_TraceDrain(pxBenchDisk, xEvents, benchTRACE_DRAIN_EVENTS);
+		fwrite(xEvents, sizeof(spansion_trace_event_t), uxCount, pxTraceFile);
+	} while(uxCount == benchTRACE_DRAIN_EVENTS);
+}
+
+/**
+ * @fn static void prvMeasureStart(bench_measurement_t *pxMeasurement, const char *pcName)
+ * @brief Saves the virtual time and the simulator counters.
+ */
+static void prvMeasureStart(bench_measurement_t *pxMeasurement, const char *pcName)
+{
+	pxMeasurement->pcName = pcName;
+	pxMeasurement->ullStart = xGetHighResolutionTime();
+	vSpansionSim_GetStats(0, &pxMeasurement->xStats);
+}
+
+/**
+ * @fn static void prvMeasureEnd(bench_measurement_t *pxMeasurement, uint32_t ulBytes)
+ * @brief Prints one CSV line with the differences since prvMeasureStart().
+ */
+static void prvMeasureEnd(bench_measurement_t *pxMeasurement, uint32_t ulBytes)
+{
+	spansion_sim_stats_t xStats;
+	uint64_t ullElapsed = xGetHighResolutionTime() - pxMeasurement->ullStart;
+	double dKiBps = 0.0;
+
+	vSpansionSim_GetStats(0, &xStats);
+	if(ullElapsed > 0)
+	{
+		dKiBps = ((double)ulBytes / 1024.0) / ((double)ullElapsed / 1000000.0);
+	}
+
+	printf("%s,%u,%.1f,%.1f,%llu,%u,%u,%u,%u,%.1f\n",
+			pxMeasurement->pcName,
+			(unsigned)ulBytes,
+			(double)ullElapsed / 1000.0,
+			dKiBps,
+			(unsigned long long)(xStats.ullSpiClocks - pxMeasurement->xStats.ullSpiClocks),
+			(unsigned)(xStats.ulReadBytes - pxMeasurement->xStats.ulReadBytes),
+			(unsigned)(xStats.ulPagePrograms - pxMeasurement->xStats.ulPagePrograms),
+			(unsigned)(xStats.ulSectorErases - pxMeasurement->xStats.ulSectorErases),
+			(unsigned)(xStats.ulBlockErases - pxMeasurement->xStats.ulBlockErases),
+			(double)(xStats.ullBusyTime - pxMeasurement->xStats.ullBusyTime) / 1000.0);
+	fflush(stdout);
+
+	if(xStats.ulNorViolations != pxMeasurement->xStats.ulNorViolations)
+	{
+		printf("# %s: %u bytes programmed with 0 -> 1 bit transitions!\n", pxMeasurement->pcName,
+				(unsigned)(xStats.ulNorViolations - pxMeasurement->xStats.ulNorViolations));
+	}
+}
+
+/**
+ * @fn static void prvSync(FF_Disk_t *pxDisk)
+ * @brief Flushes the IOManager buffers and the write back cache of the driver.
+ */
+static void prvSync(FF_Disk_t *pxDisk)
+{
+	FF_FlushCache(pxDisk->pxIOManager);
+	while(xSpansionSPI_SyncCache(pxDisk, 0) != pdTRUE);
+}
+
+/**
+ * @fn static void prvFillChunk(uint32_t ulOffset, uint8_t ucSeed)
+ * @brief Fills the chunk buffer with a position dependent pattern.
+ */
+static void prvFillChunk(uint32_t ulOffset, uint8_t ucSeed)
+{
+	uint32_t i;
+
+	for(i = 0; i < benchCHUNK_SIZE; i++)
+	{
+		ucChunk[i] = (uint8_t)(((ulOffset + i) * 31) >> 3) ^ ucSeed;
+	}
+}
+
+static BaseType_t prvWriteFile(const char *pcPath, const char *pcMode, uint32_t ulSize, uint8_t ucSeed)
+{
+	FF_FILE *pxFile;
+	uint32_t ulOffset, ulLength;
+
+	pxFile = ff_fopen(pcPath, pcMode);
+	if(pxFile == NULL)
+	{
+		fprintf(stderr, "ff_fopen(%s, %s) failed.\n", pcPath, pcMode);
+		return(pdFAIL);
+	}
+
+	for(ulOffset = 0; ulOffset < ulSize; ulOffset += ulLength)
+	{
+		ulLength = (ulSize - ulOffset < benchCHUNK_SIZE) ? ulSize - ulOffset : benchCHUNK_SIZE;
+		prvFillChunk(ulOffset, ucSeed);
+		if(ff_fwrite(ucChunk, 1, ulLength, pxFile) != ulLength)
+		{
+			break;
+		}
+	}
+	ff_fclose(pxFile);
+
+	return((ulOffset >= ulSize) ? pdPASS : pdFAIL);
+}
+
+static BaseType_t prvReadFile(const char *pcPath, uint32_t ulSize)
+{
+	FF_FILE *pxFile;
+	uint32_t ulOffset, ulLength;
+
+	pxFile = ff_fopen(pcPath, "r");
+	if(pxFile == NULL)
+	{
+		fprintf(stderr, "ff_fopen(%s, r) failed.\n", pcPath);
+		return(pdFAIL);
+	}
+
+	for(ulOffset = 0; ulOffset < ulSize; ulOffset += ulLength)
+	{
+		ulLength = (ulSize - ulOffset < benchCHUNK_SIZE) ? ulSize - ulOffset : benchCHUNK_SIZE;
+		if(ff_fread(ucChunk, 1, ulLength, pxFile) != ulLength)
+		{
+			break;
+		}
+	}
+	ff_fclose(pxFile);
+
+	return((ulOffset >= ulSize) ? pdPASS : pdFAIL);
+}
@@ -0,0 +1,368 @@
+/**
+ * @file ma_spansion_s25fl1xxk_sim_test.c
+ *
+ * @brief Randomized consistency test of the Spansion S25FL1xxk driver on the host simulator.
+ * Random multi-sector reads, writes and cache syncs are issued through the block device
+ * callbacks of the disk and checked against a reference image. At the end the disk is synced,
+ * read back completely, mounted a second time (FTL log replay, no cache) and read back again.
+ * The test fails on any mismatch and on the simulator counters of the protocol errors:
+ * 0 -> 1 bit programming, commands to a busy device, reads of a suspended area and
+ * unsupported opcodes.
+ *
+ * Build (FreeRTOS kernel POSIX port and FreeRTOS+FAT sources are needed):
+ *   gcc -DspansionSPI_PORT=spansionSPI_PORT_HOST_SIMULATOR
+ *       -I<driver>/include -I<driver> -I<FreeRTOS+FAT>/include -I<FreeRTOS>/include
+ *       -I<FreeRTOS>/portable/ThirdParty/GCC/Posix -I<config dir>
+ *       <driver>/ma_spansion_s25flxxk.c <driver>/benchmark/ma_spansion_s25fl1xxk_sim_test.c
+ *       <FreeRTOS+FAT sources> <FreeRTOS kernel sources> -lpthread -o spansion_sim_test
+ *
+ * Usage: spansion_sim_test [-n operations] [-r seed]
+ *   The exit status is 0 if the test passed.
+ *
+ * @author Lovas Szilárd <lovas.szilard@gmail.com>
+ * @version: 0.1
+ * @date: 2017-08-07 10:00
+ * - initial version
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* FreeRTOS+FAT includes. */
+#include "ff_headers.h"
+
+#include "ma_spansion_s25fl1xxk.h"
+#include "ma_spansion_s25fl1xxk_simulator.h"
+
+#define simtestDISK_NAME			"/spi"
+#define simtestREMOUNT_NAME			"/spi2"
+#define simtestDEFAULT_OPERATIONS	20000
+#define simtestREGION_SECTORS		4096		/* Sectors exercised from the first FAT sector. */
+#define simtestMAX_SECTORS			64			/* Longest read / write. */
+#define simtestSYNC_PERIOD			500			/* Average number of operations between syncs. */
+#define simtestTASK_STACK_SIZE		(configMINIMAL_STACK_SIZE * 8)
+
+static uint32_t ulOperations = simtestDEFAULT_OPERATIONS;
+static uint32_t ulRandom = 12345;
+static uint8_t *pucReference = NULL;
+static uint8_t ucBuffer[simtestMAX_SECTORS * spansionFAT_SECTOR_SIZE];
+static uint8_t ucCheck[simtestMAX_SECTORS * spansionFAT_SECTOR_SIZE];
+
+static void prvTestTask(void *pvParameters);
+static uint32_t prvRandom(void);
+static void prvFillBuffer(const uint8_t *pucOld, uint32_t ulLength);
+static FF_Error_t prvRead(FF_Disk_t *pxDisk, uint8_t *pucBuffer, uint32_t ulSector, uint32_t ulCount);
+static FF_Error_t prvWrite(FF_Disk_t *pxDisk, uint8_t *pucBuffer, uint32_t ulSector, uint32_t ulCount);
+static void prvSync(FF_Disk_t *pxDisk);
+static BaseType_t prvVerify(FF_Disk_t *pxDisk, uint32_t ulFirst, uint32_t ulCount, const char *pcPhase);
+static BaseType_t prvCheckCounters(void);
+
+/**
+ * @fn void vLoggingPrintf(const char *pcFormat, ...)
+ * @brief Sink of the FreeRTOS+FAT messages (stderr).
+ */
+void vLoggingPrintf(const char *pcFormat, ...)
+{
+	va_list xArgs;
+
+	va_start(xArgs, pcFormat);
+	vfprintf(stderr, pcFormat, xArgs);
+	va_end(xArgs);
+}
+
+int main(int argc, char **argv)
+{
+	int iOption;
+
+	while((iOption = getopt(argc, argv, "n:r:")) != -1)
+	{
+		switch(iOption)
+		{
+			case 'n':
+				ulOperations = (uint32_t)strtoul(optarg, NULL, 0);
+				break;
+			case 'r':
+				ulRandom = (uint32_t)strtoul(optarg, NULL, 0);
+				break;
+			default:
+				fprintf(stderr, "usage: %s [-n operations] [-r seed]\n", argv[0]);
+				return(EXIT_FAILURE);
+		}
+	}
+
+	if(xSpansionSim_Open(0, NULL) != pdPASS)
+	{
+		fprintf(stderr, "Can not open the flash backing store.\n");
+		return(EXIT_FAILURE);
+	}
+
+	xTaskCreate(prvTestTask, "test", simtestTASK_STACK_SIZE, NULL, tskIDLE_PRIORITY + 1, NULL);
+	vTaskStartScheduler();
+
+	return(EXIT_FAILURE);
+}
+
+/**
+ * @fn static void prvTestTask(void *pvParameters)
+ * @brief Formats the emulated disk, runs the random operations and checks the result.
+ */
+static void prvTestTask(void *pvParameters)
+{
+	FF_Disk_t *pxDisk, *pxRemount;
+	uint32_t ulFirst, ulRegion, ulSector, ulCount, i;
+
+	(void)pvParameters;
+
+	pxDisk = FF_SPIDiskInit(simtestDISK_NAME, pdTRUE);
+	if(pxDisk == NULL)
+	{
+		fprintf(stderr, "FF_SPIDiskInit failed.\n");
+		exit(EXIT_FAILURE);
+	}
+
+	/* The boot sector is kept, the second mount needs it. The FAT sectors are exercised
+	 * as well, they take another path in the driver (trace, FTL). */
+	ulFirst = pxDisk->pxIOManager->xPartition.ulFATBeginLBA;
+	ulRegion = pxDisk->ulNumberOfSectors - ulFirst;
+	if(ulRegion > simtestREGION_SECTORS)
+	{
+		ulRegion = simtestREGION_SECTORS;
+	}
+
+	pucReference = (uint8_t *)malloc(ulRegion * spansionFAT_SECTOR_SIZE);
+	if(pucReference == NULL)
+	{
+		fprintf(stderr, "Out of memory.\n");
+		exit(EXIT_FAILURE);
+	}
+	for(ulSector = 0; ulSector < ulRegion; ulSector += ulCount)
+	{
+		ulCount = (ulRegion - ulSector < simtestMAX_SECTORS) ? ulRegion - ulSector : simtestMAX_SECTORS;
+		if(prvRead(pxDisk, &pucReference[ulSector * spansionFAT_SECTOR_SIZE], ulFirst + ulSector, ulCount) != 0)
+		{
+			fprintf(stderr, "Initial read failed at sector %u.\n", (unsigned)(ulFirst + ulSector));
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	for(i = 0; i < ulOperations; i++)
+	{
+		/* Mostly short transfers, sometimes long ones, a third of them on the FAT. */
+		ulCount = 1 + prvRandom() % (((prvRandom() % 8) == 0) ? simtestMAX_SECTORS : 8);
+		if((prvRandom() % 3) == 0)
+		{
+			ulSector = prvRandom() % (pxDisk->pxIOManager->xPartition.ulSectorsPerFAT * pxDisk->pxIOManager->xPartition.ucNumFATS);
+		}
+		else
+		{
+			ulSector = prvRandom() % ulRegion;
+		}
+		if((prvRandom() % 4) == 0)
+		{
+			ulSector &= ~(uint32_t)7;	/* Aligned to a flash sector. */
+		}
+		if(ulSector >= ulRegion)
+		{
+			ulSector = 0;
+		}
+		if(ulSector + ulCount > ulRegion)
+		{
+			ulCount = ulRegion - ulSector;
+		}
+
+		if(prvRandom() % 2)
+		{
+			prvFillBuffer(&pucReference[ulSector * spansionFAT_SECTOR_SIZE], ulCount * spansionFAT_SECTOR_SIZE);
+			if(prvWrite(pxDisk, ucBuffer, ulFirst + ulSector, ulCount) != 0)
+			{
+				fprintf(stderr, "Write failed: operation %u, sector %u, count %u.\n", (unsigned)i, (unsigned)(ulFirst + ulSector), (unsigned)ulCount);
+				exit(EXIT_FAILURE);
+			}
+			memcpy(&pucReference[ulSector * spansionFAT_SECTOR_SIZE], ucBuffer, ulCount * spansionFAT_SECTOR_SIZE);
+		}
+		else
+		{
+			if(prvRead(pxDisk, ucCheck, ulFirst + ulSector, ulCount) != 0)
+			{
+				fprintf(stderr, "Read failed: operation %u, sector %u, count %u.\n", (unsigned)i, (unsigned)(ulFirst + ulSector), (unsigned)ulCount);
+				exit(EXIT_FAILURE);
+			}
+			if(memcmp(ucCheck, &pucReference[ulSector * spansionFAT_SECTOR_SIZE], ulCount * spansionFAT_SECTOR_SIZE) != 0)
+			{
+				fprintf(stderr, "Mismatch: operation %u, sector %u, count %u.\n", (unsigned)i, (unsigned)(ulFirst + ulSector), (unsigned)ulCount);
+				exit(EXIT_FAILURE);
+			}
+		}
+
+		if((prvRandom() % simtestSYNC_PERIOD) == 0)
+		{
+			prvSync(pxDisk);
+		}
+	}
+
+	prvSync(pxDisk);
+	if(prvVerify(pxDisk, ulFirst, ulRegion, "synced disk") != pdPASS)
+	{
+		exit(EXIT_FAILURE);
+	}
+
+	/* A second disk of the chip sees the flash content only. */
+	pxRemount = FF_SPIDiskInit(simtestREMOUNT_NAME, pdFALSE);
+	if(pxRemount == NULL)
+	{
+		fprintf(stderr, "FF_SPIDiskInit (remount) failed.\n");
+		exit(EXIT_FAILURE);
+	}
+	if(prvVerify(pxRemount, ulFirst, ulRegion, "remounted disk") != pdPASS)
+	{
+		exit(EXIT_FAILURE);
+	}
+
+	if(prvCheckCounters() != pdPASS)
+	{
+		exit(EXIT_FAILURE);
+	}
+
+	printf("PASS: %u operations on %u sectors\n", (unsigned)ulOperations, (unsigned)ulRegion);
+	vSpansionSim_Close(0);
+	exit(EXIT_SUCCESS);
+}
+
+/**
+ * @fn static uint32_t prvRandom(void)
+ * @brief Linear congruential generator: the sequence only depends on the seed (-r).
+ */
+static uint32_t prvRandom(void)
+{
+	ulRandom = ulRandom * 1103515245UL + 12345UL;
+	return(ulRandom >> 8);
+}
+
+/**
+ * @fn static void prvFillBuffer(const uint8_t *pucOld, uint32_t ulLength)
+ * @brief Fills the write buffer with new content of a random kind: random data, erased
+ * (0xFF), bits cleared only (no erase is needed), the same data or a changed header.
+ * @param pucOld current content of the sectors
+ * @param ulLength length of the write
+ */
+static void prvFillBuffer(const uint8_t *pucOld, uint32_t ulLength)
+{
+	uint32_t ulKind = prvRandom() % 5;
+	uint32_t i;
+
+	for(i = 0; i < ulLength; i++)
+	{
+		switch(ulKind)
+		{
+			case 0:
+				ucBuffer[i] = (uint8_t)prvRandom();
+				break;
+			case 1:
+				ucBuffer[i] = 0xff;
+				break;
+			case 2:
+				ucBuffer[i] = pucOld[i] & (uint8_t)prvRandom();
+				break;
+			case 3:
+				ucBuffer[i] = pucOld[i];
+				break;
+			default:
+				ucBuffer[i] = ((i % spansionFAT_SECTOR_SIZE) < 16) ? (uint8_t)prvRandom() : pucOld[i];
+				break;
+		}
+	}
+}
+
+/**
+ * @fn static FF_Error_t prvRead(FF_Disk_t *pxDisk, uint8_t *pucBuffer, uint32_t ulSector, uint32_t ulCount)
+ * @brief Reads sectors through the block device of the disk, retries while the driver is busy.
+ */
+static FF_Error_t prvRead(FF_Disk_t *pxDisk, uint8_t *pucBuffer, uint32_t ulSector, uint32_t ulCount)
+{
+	FF_Error_t xError;
+
+	while((xError = pxDisk->pxIOManager->xBlkDevice.fnpReadBlocks(pucBuffer, ulSector, ulCount, pxDisk)) == FF_ERR_DRIVER_BUSY)
+	{
+		vTaskDelay(1);
+	}
+	return(xError);
+}
+
+/**
+ * @fn static FF_Error_t prvWrite(FF_Disk_t *pxDisk, uint8_t *pucBuffer, uint32_t ulSector, uint32_t ulCount)
+ * @brief Writes sectors through the block device of the disk, retries while the driver is busy.
+ */
+static FF_Error_t prvWrite(FF_Disk_t *pxDisk, uint8_t *pucBuffer, uint32_t ulSector, uint32_t ulCount)
+{
+	FF_Error_t xError;
+
+	while((xError = pxDisk->pxIOManager->xBlkDevice.fnpWriteBlocks(pucBuffer, ulSector, ulCount, pxDisk)) == FF_ERR_DRIVER_BUSY)
+	{
+		vTaskDelay(1);
+	}
+	return(xError);
+}
+
+/**
+ * @fn static void prvSync(FF_Disk_t *pxDisk)
+ * @brief Flushes the IOManager buffers and the write back cache of the driver.
+ */
+static void prvSync(FF_Disk_t *pxDisk)
+{
+	FF_FlushCache(pxDisk->pxIOManager);
+	while(xSpansionSPI_SyncCache(pxDisk, 0) != pdTRUE);
+}
+
+/**
+ * @fn static BaseType_t prvVerify(FF_Disk_t *pxDisk, uint32_t ulFirst, uint32_t ulCount, const char *pcPhase)
+ * @brief Reads back the exercised sectors and compares them with the reference image.
+ * @return pdPASS if they are equal.
+ */
+static BaseType_t prvVerify(FF_Disk_t *pxDisk, uint32_t ulFirst, uint32_t ulCount, const char *pcPhase)
+{
+	uint32_t ulSector, ulLength;
+
+	for(ulSector = 0; ulSector < ulCount; ulSector += ulLength)
+	{
+		ulLength = (ulCount - ulSector < simtestMAX_SECTORS) ? ulCount - ulSector : simtestMAX_SECTORS;
+		if((prvRead(pxDisk, ucCheck, ulFirst + ulSector, ulLength) != 0) ||
+				(memcmp(ucCheck, &pucReference[ulSector * spansionFAT_SECTOR_SIZE], ulLength * spansionFAT_SECTOR_SIZE) != 0))
+		{
+			fprintf(stderr, "%s: mismatch or read error in sectors %u..%u.\n", pcPhase,
+					(unsigned)(ulFirst + ulSector), (unsigned)(ulFirst + ulSector + ulLength - 1));
+			return(pdFAIL);
+		}
+	}
+	return(pdPASS);
+}
+
+/**
+ * @fn static BaseType_t prvCheckCounters(void)
+ * @brief Prints the simulator counters and checks the protocol error counters.
+ * @return pdPASS if no protocol error was counted.
+ */
+static BaseType_t prvCheckCounters(void)
+{
+	spansion_sim_stats_t xStats;
+
+	vSpansionSim_GetStats(0, &xStats);
+	printf("page_programs=%u sector_erases=%u block_erases=%u suspends=%u\n",
+			(unsigned)xStats.ulPagePrograms, (unsigned)xStats.ulSectorErases,
+			(unsigned)xStats.ulBlockErases, (unsigned)xStats.ulSuspends);
+
+	if((xStats.ulNorViolations != 0) || (xStats.ulBusyViolations != 0) ||
+			(xStats.ulSuspendViolations != 0) || (xStats.ulUnsupportedCommands != 0))
+	{
+		fprintf(stderr, "Protocol errors: nor=%u busy=%u suspend=%u unsupported=%u\n",
+				(unsigned)xStats.ulNorViolations, (unsigned)xStats.ulBusyViolations,
+				(unsigned)xStats.ulSuspendViolations, (unsigned)xStats.ulUnsupportedCommands);
+		return(pdFAIL);
+	}
+	return(pdPASS);
+}
@@ -1,35 +1,65 @@
-/**
- * @file ma_spansion_s25fl1xxk.h
- *
- * @brief FreeRTOS+FAT driver for Spansion S25FL1xxk SPI flash devices.
- * @author Lovas Szilrd <lovas.szilard@gmail.com>
- * @Version: 0.2
- * @Date: 2017-03-26 8:00
- * - initial version
- * @date: 2017-05-03 8:00
- * - 0.2
- * + function BaseType_t xSpansionSPI_IsChipEraseInProgress(void) added.
- */
-
-/* FreeRTOS+FAT includes. */
-#include "ff_headers.h"
-#include "ff_sys.h"
-
-#include "ma_spansion_s25fl1xxk_driver_config.h"
-
-#if(cacheSPI_CACHE_SIZE > 0)
-#include "ma_spansion_s25fl1xxk_cache.h"
-#else
-#include "ma_spansion_s25fl1xxk_noncache.h"
-#endif
-
-#ifndef FREERTOS_PLUS_FAT_PORTABLE_SPANSION_S25FL1XXK_INCLUDE_MA_SPANSION_S25FL1XXK_H_
-#define FREERTOS_PLUS_FAT_PORTABLE_SPANSION_S25FL1XXK_INCLUDE_MA_SPANSION_S25FL1XXK_H_
-
-FF_Disk_t *FF_SPIDiskInit(char *pcName, uint8_t ucNeedFormat);
-BaseType_t xSpansionSPI_SyncCache(FF_Disk_t *pxDisk, cache_stamp_t xOlderThan);
-void vSpansionSPI_PartitionAndFormatDisk(char *pcName);
-void vSpansionSPI_ChipErase(void);
-BaseType_t xSpansionSPI_IsChipEraseInProgress(void);
-
-#endif /* FREERTOS_PLUS_FAT_PORTABLE_SPANSION_S25FL1XXK_INCLUDE_MA_SPANSION_S25FL1XXK_H_ */
+/**
+ * @file ma_spansion_s25fl1xxk.h
+ *
+ * @brief FreeRTOS+FAT driver for Spansion S25FL1xxk SPI flash devices.
+ * @author Lovas Szilárd <lovas.szilard@gmail.com>
+ * @Version: 0.8
+ * @Date: 2017-03-26 8:00
+ * - initial version
+ * @date: 2017-05-03 8:00
+ * - 0.2
+ * + function BaseType_t xSpansionSPI_IsChipEraseInProgress(void) added.
+ * @date: 2017-06-26 10:00
+ * - 0.3
+ * + Transport interface.
+ * @date: 2017-07-10 10:00
+ * - 0.4
+ * + Per disk context (FF_Disk_t.pvTag), several chips: FF_SPIDiskInitEx(), pxSpansionSPI_GetTransport().
+ * @date: 2017-07-24 10:00
+ * - 0.5
+ * + Statistics: vSpansionSPI_GetStats(), vSpansionSPI_ResetStats().
+ * @date: 2017-07-31 10:00
+ * - 0.6
+ * + Binary trace ring: uxSpansionSPI_TraceDrain().
+ * @date: 2017-08-21 10:00
+ * - 0.7
+ * + Discard: xSpansionSPI_Discard(), xSpansionSPI_DiscardFreeClusters().
+ * @date: 2017-10-02 10:00
+ * - 0.8
+ * + Chip identification: vSpansionSPI_GetGeometry().
+ */
+
+/* FreeRTOS+FAT includes. */
+#include "ff_headers.h"
+#include "ff_sys.h"
+
+#include "ma_spansion_s25fl1xxk_driver_config.h"
+#include "ma_spansion_s25fl1xxk_transport.h"
+
+#if(cacheSPI_CACHE_SIZE > 0)
+#include "ma_spansion_s25fl1xxk_cache.h"
+#else
+#include "ma_spansion_s25fl1xxk_noncache.h"
+#endif
+#include "ma_spansion_s25fl1xxk_context.h"
+
+#ifndef FREERTOS_PLUS_FAT_PORTABLE_SPANSION_S25FL1XXK_INCLUDE_MA_SPANSION_S25FL1XXK_H_
+#define FREERTOS_PLUS_FAT_PORTABLE_SPANSION_S25FL1XXK_INCLUDE_MA_SPANSION_S25FL1XXK_H_
+
+FF_Disk_t *FF_SPIDiskInit(char *pcName, uint8_t ucNeedFormat);
+FF_Disk_t *FF_SPIDiskInitEx(char *pcName, uint8_t ucNeedFormat, const spansion_disk_config_t *pxConfig);
+const spansion_transport_t *pxSpansionSPI_GetTransport(UBaseType_t uxDevice);
+BaseType_t xSpansionSPI_SyncCache(FF_Disk_t *pxDisk, cache_stamp_t xOlderThan);
+BaseType_t xSpansionSPI_Discard(FF_Disk_t *pxDisk, uint32_t ulSectorNumber, uint32_t ulSectorCount);
+BaseType_t xSpansionSPI_DiscardFreeClusters(FF_Disk_t *pxDisk);
+void vSpansionSPI_GetStats(FF_Disk_t *pxDisk, spansion_stats_t *pxStats);
+void vSpansionSPI_ResetStats(FF_Disk_t *pxDisk);
+void vSpansionSPI_GetGeometry(FF_Disk_t *pxDisk, spansion_geometry_t *pxGeometry);
+UBaseType_t uxSpansionSPI_TraceDrain(FF_Disk_t *pxDisk, spansion_trace_event_t *pxEvents, UBaseType_t uxMaxEvents);
+void vSpansionSPI_PartitionAndFormatDisk(char *pcName);
+void vSpansionSPI_ChipErase(FF_Disk_t *pxDisk);
+BaseType_t xSpansionSPI_IsChipEraseInProgress(FF_Disk_t *pxDisk);
+BaseType_t xSpansionSPI_StartWriteback(FF_Disk_t *pxDisk, const cache_writeback_config_t *pxConfig);
+void vSpansionSPI_GetWritebackStatus(FF_Disk_t *pxDisk, cache_writeback_status_t *pxStatus);
+
+#endif /* FREERTOS_PLUS_FAT_PORTABLE_SPANSION_S25FL1XXK_INCLUDE_MA_SPANSION_S25FL1XXK_H_ */
@@ -1,72 +1,361 @@
-/**
- * @file ma_spi_flash_cache.h
- *
- * @brief WriteBack cache API for SPI flash devices.
- * @author Lovas Szilrd <lovas.szilard@gmail.com>
- * @Version: 0.1
- * @Date: 2017-02-16 14:00
- * - 0.1 - initial version
- */
-
-#ifndef MA_SPI_FLASH_CACHE_H_
-#define MA_SPI_FLASH_CACHE_H_
-
-#include <stdint.h>
-#include "ma_spansion_s25fl1xxk_command_set.h"
-
-typedef enum {INVALID, VALID, MODIFIED, INCOMPATIBLE} cache_state_t;
-typedef uint64_t cache_stamp_t;
-typedef int8_t	cache_index_t;
-typedef uint8_t cache_size_t;
-
-typedef struct {
-	uint32_t		Tag;					/* Cache Tag (Address). */
-	cache_state_t	State;					/* Cache State. */
-	cache_stamp_t	Stamp;					/* Time stamp for Last usage for LRU replacement. */
-	uint8_t			Line[cacheLINE_SIZE];	/* Cache data. */
-} cache_entry_t;
-
-typedef struct {
-	uint32_t		WriteHits;
-	uint32_t		WriteMisses;
-	uint32_t		ReadHits;
-	uint32_t		ReadMisses;
-	uint32_t		Hits;					/* Write + Read hits.*/
-	uint32_t		Misses;					/* Write + Read misses.*/
-
-} cache_stats_t;
-
-
-static int32_t prvSpansionSPI_FFRead( uint8_t *pucDestination,	/* Destination for data being read. */
-							uint32_t ulSectorNumber,			/* Sector from which to start reading data. */
-							uint32_t ulSectorCount,				/* Number of sectors to read. */
-							FF_Disk_t *pxDisk );				/* Describes the disk being read from. */
-
-static int32_t prvSpansionSPI_FFWrite( uint8_t *pucSource,		/* Source of data to be written. */
-							uint32_t ulSectorNumber,			/* The first sector being written to. */
-							uint32_t ulSectorCount,				/* The number of sectors to write. */
-							FF_Disk_t *pxDisk );				/* Describes the disk being written to. */
-
-/* Cache init, flush, read and write functions. */
-static void prvSpansionSPI_InitCache(cache_entry_t * xCache, cache_size_t xSize);
-static void prvSpansionSPI_FlushCache(cache_entry_t * xCache, cache_size_t xSize);
-static cache_index_t prvSpansionSPI_ReadCache(cache_entry_t * pxCache, cache_size_t xCacheSize, uint32_t xSpiAddress);
-static cache_index_t prvSpansionSPI_WriteCache(cache_entry_t * pxCache, cache_size_t xCacheSize, uint8_t * pucSource, uint32_t xSpiAddress);
-static cache_stamp_t prvSpansionSPI_TimeStamp(void);
-
-/* SPI sector read, write and erase functions. */
-static void prvSpansionSPI_SectorRead(uint8_t * pucDestination, uint32_t xSpiAddress);
-static void prvSpansionSPI_SectorWrite(uint8_t *pucSource, uint32_t xSpiAddress);
-static void prvSpansionSPI_SectorErase(uint32_t xSpiAddress);
-
-/* Middle level functions. */
-static uint8_t prvSpansionSPI_IsBusy(void);
-static void prvSpansionSPI_WriteEnable(void);
-static void prvSpansionSPI_WriteDisable(void);
-static void prvSpansionSPI_ChipErase(void);
-static FF_Error_t prvPartitionAndFormatDisk( FF_Disk_t *pxDisk );
-
-/* Low level functions. */
-static uint8_t xSpiTransferByte(uint8_t xTX_Data);
-
-#endif /* FREERTOS_PLUS_FAT_PORTABLE_HERCULES_S25FL1XXK_MA_SPI_FLASH_CACHE_H_ */
+/**
+ * @file ma_spi_flash_cache.h
+ *
+ * @brief WriteBack cache API for SPI flash devices.
+ * @author Lovas Szilárd <lovas.szilard@gmail.com>
+ * @Version: 0.9
+ * @Date: 2017-02-16 14:00
+ * - 0.1 - initial version
+ * @Date: 2017-07-10 10:00
+ * - 0.2 - The functions get the per disk context (spansion_context_t).
+ * @Date: 2017-07-17 10:00
+ * - 0.3 - Block erase functions.
+ * @Date: 2017-07-24 10:00
+ * - 0.4 - Statistics: per area counters, latency histograms.
+ * @Date: 2017-08-21 10:00
+ * - 0.5 - Discard: known erased / discarded line bitmaps.
+ * @Date: 2017-08-28 10:00
+ * - 0.6 - Sequential read-ahead of the data area.
+ * @Date: 2017-09-04 10:00
+ * - 0.7 - Partial line fills: valid FAT sectors of the entries.
+ * @Date: 2017-09-18 10:00
+ * - 0.8 - Fast format: the cache is dropped before the disk is erased.
+ * @Date: 2017-09-25 10:00
+ * - 0.9 - Adaptive replacement: recent / frequent lists, ghost lists, resizable partitions.
+ */
+
+#ifndef MA_SPI_FLASH_CACHE_H_
+#define MA_SPI_FLASH_CACHE_H_
+
+#include <stdint.h>
+#include "ma_spansion_s25fl1xxk_command_set.h"
+
+typedef enum {INVALID, VALID, MODIFIED, INCOMPATIBLE} cache_state_t;
+typedef uint64_t cache_stamp_t;
+typedef int16_t	cache_index_t;
+typedef uint16_t cache_size_t;
+
+#define cacheNO_ENTRY		((cache_index_t)-1)
+#define cacheNO_LINE		0xffffffffUL
+
+/* Per disk driver context (ma_spansion_s25fl1xxk_context.h). */
+typedef struct xSPANSION_CONTEXT spansion_context_t;
+
+/* Cache entry metadata, the line data is kept in a separate pool. */
+typedef struct {
+	cache_stamp_t	Stamp;					/* Time stamp for Last usage for LRU replacement. */
+	uint32_t		Tag;					/* Cache Tag (Address). */
+	uint8_t			*Line;					/* Cache data (cacheLINE_SIZE bytes). */
+	cache_index_t	HashNext;				/* Next entry on the same tag hash chain. */
+	cache_index_t	LruPrev;				/* Previous (more recently used) entry of the list. */
+	cache_index_t	LruNext;				/* Next (less recently used) entry of the list. */
+	cache_index_t	DirtyPrev;				/* Previous (newer) entry of the dirty list. */
+	cache_index_t	DirtyNext;				/* Next (older) entry of the dirty list. */
+	uint8_t			State;					/* Cache State (cache_state_t). */
+	uint8_t			Partition;				/* Owner partition (FAT / data area). */
+	uint8_t			List;					/* LRU list of the partition (cacheLIST_xxx). */
+	uint8_t			UsedSectors;			/* FAT sectors accessed since the fill (cachePOLICY_ADAPTIVE). */
+	uint16_t		DirtyPages;				/* Pages differing from the flash (bit n: page n). */
+	uint8_t			ValidSectors;			/* FAT sectors of the line read into Line (bit n: sector n). */
+	uint8_t			Fill;					/* How the line was filled, until the read-ahead detector sees it (cacheFILL_xxx). */
+} cache_entry_t;
+
+#define cacheIS_DIRTY(State)	((State) >= MODIFIED)
+
+/* FAT sector masks of a line (cache_entry_t.ValidSectors). */
+#define cacheALL_SECTORS					((uint8_t)((1 << cacheSECTORS_PER_LINE) - 1))
+#define cacheSECTOR_MASK(xSpiAddress, ulCount)	((uint8_t)(((1 << (ulCount)) - 1) << (((xSpiAddress) & 0x00000fff) / spansionFAT_SECTOR_SIZE)))
+
+/* Line fill of an entry (cache_entry_t.Fill). */
+#define cacheFILL_USED			0			/* Seen by the read-ahead detector, or not filled by a read. */
+#define cacheFILL_MISS			1			/* Filled on a miss. */
+#define cacheFILL_AHEAD			2			/* Prefetched by the read-ahead, not read since. */
+
+/* Write back task configuration. */
+typedef struct {
+	cache_stamp_t	OlderThan;				/* Write back dirty entries unused for this long (0: no age limit). */
+	cache_size_t	HighWatermark;			/* Start writing back above this number of dirty entries. */
+	cache_size_t	LowWatermark;			/* ... and continue down to this number of dirty entries. */
+	TickType_t		Period;					/* Wake up period of the task. */
+} cache_writeback_config_t;
+
+/* Write back task status. */
+typedef struct {
+	cache_size_t	DirtyLines;				/* Dirty entries after the last pass. */
+	uint32_t		FlushedLines;			/* Entries written back by the task. */
+	uint32_t		Wakeups;				/* Task wake ups. */
+	uint32_t		Deferred;				/* Passes skipped, the disk mutex was not available. */
+	BaseType_t		Running;				/* The task has been started. */
+} cache_writeback_status_t;
+
+/* Write back step results. */
+#define cacheWRITEBACK_IDLE		0	/* Nothing to do. */
+#define cacheWRITEBACK_STARTED	1	/* An erase or a page program has been started. */
+#define cacheWRITEBACK_BUSY		2	/* The previous operation is still running. */
+
+#if(cacheSPI_DISCARD_ENABLE)
+/* Line bitmaps of the chip (bit n % 32 of word n / 32: line n). */
+#define cacheDISCARD_LINES		((spansionSPI_SECTOR_COUNT * spansionFAT_SECTOR_SIZE) / cacheLINE_SIZE)
+#define cacheDISCARD_MAP_WORDS	((cacheDISCARD_LINES + 31) / 32)
+
+typedef struct {
+	uint32_t		Erased[cacheDISCARD_MAP_WORDS];		/* Erased by the driver, not programmed since. */
+	uint32_t		Pending[cacheDISCARD_MAP_WORDS];	/* Discarded, to be erased by the write back task. */
+	uint32_t		PendingCount;						/* Number of the discarded lines. */
+	uint32_t		NextWord;							/* Pending word where the next search starts. */
+} cache_discard_t;
+#endif
+
+#if(cacheSPI_READ_AHEAD_LINES > 0)
+/* Sequential read-ahead of the data area: the lines from Next up to End (exclusive) are prefetched. */
+typedef struct {
+	uint32_t		Last;					/* Last line of the stream (cacheNO_LINE: none). */
+	uint32_t		Other;					/* Last line read outside the open stream (cacheNO_LINE: none). */
+	uint32_t		Next;					/* Next line of the window. */
+	uint32_t		End;					/* End of the window. */
+	uint16_t		Window;					/* Lines prefetched ahead of the reader, 0: no stream. */
+	uint16_t		Max;					/* Limit of the window (a quarter of the data partition at most). */
+	uint16_t		Run;					/* Consecutive sequential misses (saturated at cacheREAD_AHEAD_TRIGGER). */
+	uint16_t		OtherRun;				/* Consecutive sequential misses ending at Other. */
+	cache_index_t	Filling;				/* Entry of the last asynchronous line fill (cacheNO_ENTRY: none). */
+} cache_readahead_t;
+
+/* Sequential misses starting the read-ahead. */
+#define cacheREAD_AHEAD_TRIGGER	2
+#endif
+
+/* Asynchronous line fills of the read-ahead keep the bus until the next access of the
+disk, so they are used only if the bus is not shared with other chips. */
+#define cacheREAD_AHEAD_ASYNC	((cacheSPI_READ_AHEAD_LINES > 0) && (spansionSPI_DEVICE_COUNT == 1))
+
+/* Intrusive LRU list of cache entries. */
+typedef struct {
+	cache_index_t	Head;					/* Most recently used entry. */
+	cache_index_t	Tail;					/* Least recently used entry (replacement victim). */
+	cache_size_t	Count;					/* Number of entries. */
+} cache_lru_t;
+
+/* LRU lists of a partition. The adaptive policy keeps the lines used once since their fill
+apart from the ones used again, so a scan replaces only lines used once. */
+#if(cacheSPI_REPLACEMENT_POLICY == cachePOLICY_ADAPTIVE)
+#define cacheLIST_RECENT		0			/* Lines used once, new lines (ARC T1). */
+#define cacheLIST_FREQUENT		1			/* Lines used again (ARC T2). */
+#define cacheLIST_COUNT			2
+#define cacheNO_LIST			cacheLIST_COUNT
+
+/* Ghost list: FIFO of the tags of the lines replaced from a list (ARC B1 / B2). It keeps at most
+as many tags as the partition has entries, the tag of a line filled again leaves a hole. The
+tags of both lists of a partition are chained in a hash (cacheHASH() of the tag), the ghost
+slot n of list l is cacheGHOST_ID(l, n). */
+typedef struct {
+	uint32_t		Tags[cacheLINE_COUNT];
+	cache_size_t	Next[cacheLINE_COUNT];	/* Next ghost on the same hash chain. */
+	cache_size_t	Oldest;					/* Slot of the oldest tag. */
+	cache_size_t	Count;					/* Tags and holes in the list. */
+} cache_ghost_t;
+
+#define cacheGHOST_ID(List, Slot)	((cache_size_t)((List) * cacheLINE_COUNT + (Slot)))
+#define cacheNO_GHOST				((cache_size_t)0xffff)
+#else
+#define cacheLIST_RECENT		0
+#define cacheLIST_COUNT			1
+#endif
+
+/* Cache partition: the entries reserved for an area. */
+typedef struct {
+	cache_lru_t		List[cacheLIST_COUNT];	/* LRU lists (cacheLIST_xxx). */
+	cache_index_t	First;					/* First entry of the partition at the start. */
+	cache_size_t	Size;					/* Number of entries. */
+#if(cacheSPI_REPLACEMENT_POLICY == cachePOLICY_ADAPTIVE)
+	cache_size_t	Target;					/* Target size of the recent list (ARC p). */
+	cache_ghost_t	Ghost[cacheLIST_COUNT];	/* Tags replaced from the lists. */
+	cache_size_t	GhostHash[cacheSPI_HASH_SIZE];	/* First ghost of the chains (cacheNO_GHOST: none). */
+#endif
+} cache_partition_t;
+
+/* Cache partitions: FAT area and data area entries are replaced separately. */
+#if(cacheSPI_CACHE_FAT_RESERVED_SIZE > 0)
+#define cachePARTITION_FAT		0
+#define cachePARTITION_DATA		1
+#define cachePARTITION_COUNT	2
+#else
+#define cachePARTITION_DATA		0
+#define cachePARTITION_COUNT	1
+#endif
+
+/* Statistics areas: FAT area and data area requests are counted separately. */
+#define cacheAREA_FAT			0
+#define cacheAREA_DATA			1
+#define cacheAREA_COUNT			2
+
+/* Latency histogram: bin 0: < 1 us, bin n: 2^(n-1) .. 2^n - 1 us, the last bin: longer. */
+#define cacheLATENCY_BINS		24
+
+typedef struct {
+	uint32_t		Count;
+	uint32_t		MaxTime;				/* [us] */
+	uint64_t		TotalTime;				/* [us] */
+	uint32_t		Histogram[cacheLATENCY_BINS];
+} cache_latency_t;
+
+/* Cache statistics of an area. */
+typedef struct {
+	uint32_t		WriteHits;
+	uint32_t		WriteMisses;
+	uint32_t		ReadHits;
+	uint32_t		ReadMisses;
+	uint32_t		Hits;					/* Write + Read hits (vSpansionSPI_GetStats()).*/
+	uint32_t		Misses;					/* Write + Read misses (vSpansionSPI_GetStats()).*/
+	uint32_t		StreamedSectors;		/* FAT sectors read bypassing the cache. */
+	uint32_t		BulkSectors;			/* FAT sectors written bypassing the cache. */
+	cache_latency_t	FFRead;					/* Requests starting in the area. */
+	cache_latency_t	FFWrite;
+} cache_stats_t;
+
+#if(cacheSTATS_ENABLE)
+#define cacheSTATS_INC(Counter)				((Counter)++)
+#define cacheSTATS_ADD(Counter, Value)		((Counter) += (Value))
+#define cacheSTATS_START(Start)				uint64_t Start = xGetHighResolutionTime()
+#define cacheSTATS_LATENCY(Latency, Start)	prvSpansionSPI_StatsLatency(&(Latency), Start)
+#else
+#define cacheSTATS_INC(Counter)
+#define cacheSTATS_ADD(Counter, Value)
+#define cacheSTATS_START(Start)
+#define cacheSTATS_LATENCY(Latency, Start)
+#endif
+
+/* Known erased lines: set by the erases, cleared by the programs. Discarded lines: set by
+xSpansionSPI_Discard(), cleared by the erases, the programs and the line fills. */
+#if(cacheSPI_DISCARD_ENABLE)
+#define cacheIS_ERASED(pxContext, xSpiAddress)				prvSpansionSPI_TestLine((pxContext)->xDiscard.Erased, xSpiAddress)
+#define cacheIS_DISCARDED(pxContext, xSpiAddress)			prvSpansionSPI_TestLine((pxContext)->xDiscard.Pending, xSpiAddress)
+#define cacheMARK_ERASED(pxContext, xSpiAddress, ulLength)	prvSpansionSPI_MarkLines(pxContext, xSpiAddress, ulLength, pdTRUE)
+#define cacheMARK_USED(pxContext, xSpiAddress, ulLength)	prvSpansionSPI_MarkLines(pxContext, xSpiAddress, ulLength, pdFALSE)
+#else
+#define cacheIS_ERASED(pxContext, xSpiAddress)				(pdFALSE)
+#define cacheIS_DISCARDED(pxContext, xSpiAddress)			(pdFALSE)
+#define cacheMARK_ERASED(pxContext, xSpiAddress, ulLength)
+#define cacheMARK_USED(pxContext, xSpiAddress, ulLength)
+#endif
+
+/* The line of an entry may still be filled by the asynchronous read of the read-ahead. */
+#if(cacheREAD_AHEAD_ASYNC)
+#define cacheREAD_AHEAD_WAIT(pxContext, xIndex)				do { if((xIndex) == (pxContext)->xReadAhead.Filling) { prvSpansionSPI_SectorReadWait(pxContext); } } while(0)
+#else
+#define cacheREAD_AHEAD_WAIT(pxContext, xIndex)
+#endif
+
+
+static int32_t prvSpansionSPI_FFRead( uint8_t *pucDestination,	/* Destination for data being read. */
+							uint32_t ulSectorNumber,			/* Sector from which to start reading data. */
+							uint32_t ulSectorCount,				/* Number of sectors to read. */
+							FF_Disk_t *pxDisk );				/* Describes the disk being read from. */
+
+static int32_t prvSpansionSPI_FFWrite( uint8_t *pucSource,		/* Source of data to be written. */
+							uint32_t ulSectorNumber,			/* The first sector being written to. */
+							uint32_t ulSectorCount,				/* The number of sectors to write. */
+							FF_Disk_t *pxDisk );				/* Describes the disk being written to. */
+
+/* Cache init, flush, read and write functions. */
+static void prvSpansionSPI_InitCache(spansion_context_t *pxContext);
+static void prvSpansionSPI_SyncCache(spansion_context_t *pxContext, cache_stamp_t xOlderThan);
+static cache_index_t prvSpansionSPI_ReadCache(spansion_context_t *pxContext, cache_partition_t * pxPartition, cache_stats_t * pxStats, uint32_t xSpiAddress, uint8_t ucSectors);
+static cache_index_t prvSpansionSPI_WriteCache(spansion_context_t *pxContext, cache_partition_t * pxPartition, cache_stats_t * pxStats, uint8_t * pucSource, uint32_t xSpiAddress);
+static void prvSpansionSPI_StreamReadCache(spansion_context_t *pxContext, uint8_t * pucDestination, uint32_t xSpiAddress, uint32_t ulLength);
+#if(cacheSPI_BULK_WRITE_ENABLE)
+static void prvSpansionSPI_BulkWriteCache(spansion_context_t *pxContext, uint8_t * pucSource, uint32_t xSpiAddress);
+#if(cacheSPI_BLOCK_ERASE_MIN_SECTORS > 0)
+static void prvSpansionSPI_BulkWriteBlock(spansion_context_t *pxContext, uint8_t * pucSource, uint32_t xSpiAddress);
+#endif
+static BaseType_t prvSpansionSPI_BulkCompare(spansion_context_t *pxContext, const uint8_t * pucSource, uint32_t xSpiAddress, uint16_t * pusPageMask);
+static void prvSpansionSPI_BulkProgram(spansion_context_t *pxContext, uint8_t * pucSource, uint32_t xSpiAddress, BaseType_t xNeedErase, uint16_t usPageMask);
+static BaseType_t prvSpansionSPI_CompareFlash(spansion_context_t *pxContext, const uint8_t * pucNew, uint32_t xSpiAddress, uint16_t * pusPageMask);
+#endif
+static uint16_t prvSpansionSPI_DiffPages(const uint8_t * pucNew, const uint8_t * pucOld, uint32_t ulOffset, uint32_t ulLength, BaseType_t * pxNeedErase);
+static uint16_t prvSpansionSPI_UsedPages(const uint8_t * pucData);
+#if(cacheSPI_BLOCK_ERASE_MIN_SECTORS > 0) || (spansionFTL_LOG_SECTORS > 0)
+static BaseType_t prvSpansionSPI_IsBlankFlash(spansion_context_t *pxContext, uint32_t xSpiAddress);
+#endif
+static cache_stamp_t prvSpansionSPI_TimeStamp(void);
+#if(cacheSTATS_ENABLE)
+static void prvSpansionSPI_StatsLatency(cache_latency_t * pxLatency, uint64_t ullStart);
+#endif
+
+/* Cache index (tag hash and LRU list) functions. */
+static cache_index_t prvSpansionSPI_LookupCache(spansion_context_t *pxContext, uint32_t xSpiAddress);
+static cache_index_t prvSpansionSPI_ReplaceCache(spansion_context_t *pxContext, cache_partition_t * pxPartition, uint32_t xSpiAddress);
+static void prvSpansionSPI_FillCache(spansion_context_t *pxContext, cache_entry_t * pxEntry, uint8_t ucSectors);
+static void prvSpansionSPI_WriteBackCache(spansion_context_t *pxContext, cache_entry_t * pxEntry);
+#if(cacheSPI_BLOCK_ERASE_MIN_SECTORS > 0)
+static BaseType_t prvSpansionSPI_FlushBlock(spansion_context_t *pxContext, uint32_t xSpiAddress);
+#endif
+static void prvSpansionSPI_HashInsert(spansion_context_t *pxContext, cache_index_t xIndex);
+static void prvSpansionSPI_HashRemove(spansion_context_t *pxContext, cache_index_t xIndex);
+static void prvSpansionSPI_LruUnlink(spansion_context_t *pxContext, cache_index_t xIndex);
+static void prvSpansionSPI_LruPushHead(spansion_context_t *pxContext, cache_index_t xIndex);
+static void prvSpansionSPI_LruPushTail(spansion_context_t *pxContext, cache_index_t xIndex);
+static void prvSpansionSPI_InvalidateCache(spansion_context_t *pxContext, cache_index_t xIndex);
+static void prvSpansionSPI_TouchCache(spansion_context_t *pxContext, cache_index_t xIndex, uint8_t ucSectors, BaseType_t xWrite);
+static cache_index_t prvSpansionSPI_SelectVictim(spansion_context_t *pxContext, cache_partition_t * pxPartition, uint32_t xSpiAddress);
+#if(cacheSPI_REPLACEMENT_POLICY == cachePOLICY_ADAPTIVE) || (cacheSPI_READ_AHEAD_LINES > 0)
+static uint8_t prvSpansionSPI_VictimList(cache_partition_t * pxPartition, BaseType_t xFrequentGhost);
+#endif
+#if(cacheSPI_REPLACEMENT_POLICY == cachePOLICY_ADAPTIVE)
+static uint8_t prvSpansionSPI_GhostRemove(cache_partition_t * pxPartition, uint32_t xSpiAddress);
+static void prvSpansionSPI_GhostInsert(cache_partition_t * pxPartition, uint8_t ucList, uint32_t xSpiAddress, cache_size_t xSize);
+static void prvSpansionSPI_GhostUnlink(cache_partition_t * pxPartition, cache_size_t xGhost);
+#endif
+static void prvSpansionSPI_DropCache(spansion_context_t *pxContext);
+static void prvSpansionSPI_SetCacheState(spansion_context_t *pxContext, cache_entry_t * pxEntry, uint8_t ucState);
+static void prvSpansionSPI_StampCache(spansion_context_t *pxContext, cache_entry_t * pxEntry);
+static void prvSpansionSPI_DirtyUnlink(spansion_context_t *pxContext, cache_entry_t * pxEntry);
+static void prvSpansionSPI_DirtyPushHead(spansion_context_t *pxContext, cache_entry_t * pxEntry);
+
+/* Write back task functions. */
+static cache_index_t prvSpansionSPI_OldestDirtyCache(spansion_context_t *pxContext);
+static void prvSpansionSPI_WriteBackStart(spansion_context_t *pxContext, cache_entry_t * pxEntry);
+static BaseType_t prvSpansionSPI_WritebackStep(spansion_context_t *pxContext);
+static void prvSpansionSPI_WritebackTask(void *pvParameters);
+
+/* Discard functions. */
+static void prvSpansionSPI_DiscardCache(spansion_context_t *pxContext, uint32_t xSpiAddress, uint32_t ulLength);
+#if(cacheSPI_DISCARD_ENABLE)
+static BaseType_t prvSpansionSPI_DiscardStep(spansion_context_t *pxContext);
+static BaseType_t prvSpansionSPI_TestLine(const uint32_t * pulMap, uint32_t xSpiAddress);
+static void prvSpansionSPI_MarkLines(spansion_context_t *pxContext, uint32_t xSpiAddress, uint32_t ulLength, BaseType_t xErased);
+#endif
+
+/* Read-ahead functions. */
+#if(cacheSPI_READ_AHEAD_LINES > 0)
+static void prvSpansionSPI_ReadAheadUpdate(spansion_context_t *pxContext, cache_entry_t * pxEntry);
+static void prvSpansionSPI_ReadAheadSchedule(spansion_context_t *pxContext);
+static BaseType_t prvSpansionSPI_ReadAheadStep(spansion_context_t *pxContext, BaseType_t xAsync);
+#endif
+
+/* SPI sector read, write and erase functions. */
+static void prvSpansionSPI_SectorRead(spansion_context_t *pxContext, uint8_t * pucDestination, uint32_t xSpiAddress);
+static void prvSpansionSPI_SectorReadPart(spansion_context_t *pxContext, uint8_t * pucDestination, uint32_t xSpiAddress, uint32_t ulSectors);
+static void prvSpansionSPI_ArrayRead(spansion_context_t *pxContext, uint8_t * pucDestination, uint32_t xSpiAddress, uint32_t ulLength);
+#if(cacheREAD_AHEAD_ASYNC)
+static void prvSpansionSPI_SectorReadStart(spansion_context_t *pxContext, uint8_t * pucDestination, uint32_t xSpiAddress);
+static void prvSpansionSPI_SectorReadWait(spansion_context_t *pxContext);
+#endif
+static void prvSpansionSPI_SectorWritePages(spansion_context_t *pxContext, uint8_t *pucSource, uint32_t xSpiAddress, uint16_t usPageMask);
+static void prvSpansionSPI_SectorErase(spansion_context_t *pxContext, uint32_t xSpiAddress);
+static void prvSpansionSPI_SectorEraseStart(spansion_context_t *pxContext, uint32_t xSpiAddress);
+#if(cacheSPI_BLOCK_ERASE_MIN_SECTORS > 0)
+static void prvSpansionSPI_BlockErase(spansion_context_t *pxContext, uint32_t xSpiAddress);
+#endif
+static void prvSpansionSPI_PageProgramStart(spansion_context_t *pxContext, uint8_t *pucSource, uint32_t xSpiAddress);
+static BaseType_t prvSpansionSPI_Suspend(spansion_context_t *pxContext, uint32_t xSpiAddress, uint32_t ulLength);
+static void prvSpansionSPI_Resume(spansion_context_t *pxContext);
+
+/* Middle level functions. */
+static BaseType_t prvSpansionSPI_IsChipEraseInProgress(spansion_context_t *pxContext);
+static uint8_t prvSpansionSPI_IsBusy(spansion_context_t *pxContext);
+static void prvSpansionSPI_WaitReady(spansion_context_t *pxContext, BaseType_t xSleep);
+static void prvSpansionSPI_WriteEnable(spansion_context_t *pxContext);
+static void prvSpansionSPI_ChipErase(spansion_context_t *pxContext);
+static FF_Error_t prvPartitionAndFormatDisk( FF_Disk_t *pxDisk );
+
+#endif /* FREERTOS_PLUS_FAT_PORTABLE_HERCULES_S25FL1XXK_MA_SPI_FLASH_CACHE_H_ */
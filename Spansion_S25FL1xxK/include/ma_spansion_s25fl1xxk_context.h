@@ -0,0 +1,155 @@
+/**
+ * @file ma_spansion_s25fl1xxk_context.h
+ *
+ * @brief Per disk context of the Spansion S25FL1xxk FreeRTOS+FAT driver.
+ * Every mounted flash chip has its own context (FF_Disk_t.pvTag): cache, pending
+ * embedded operation, transport (bus and _CS binding), geometry and mutex.
+ * @author Lovas Szilárd <lovas.szilard@gmail.com>
+ * @version: 0.11
+ * @date: 2017-07-10 10:00
+ * - initial version
+ * @date: 2017-07-17 10:00
+ * - 0.2 Sector buffer of the block erase.
+ * @date: 2017-07-24 10:00
+ * - 0.3 Statistics (spansion_stats_t).
+ * @date: 2017-07-31 10:00
+ * - 0.4 Trace ring.
+ * @date: 2017-08-14 10:00
+ * - 0.5 Flash translation layer.
+ * @date: 2017-08-21 10:00
+ * - 0.6 Known erased / discarded line bitmaps.
+ * @date: 2017-08-28 10:00
+ * - 0.7 Read-ahead state, asynchronous sector read.
+ * @date: 2017-09-04 10:00
+ * - 0.8 Partial line fill statistics.
+ * @date: 2017-09-11 10:00
+ * - 0.9 The cache has cacheLINE_COUNT entries (lines of the unified buffering included).
+ * @date: 2017-09-25 10:00
+ * - 0.10 Adaptive replacement statistics.
+ * @date: 2017-10-02 10:00
+ * - 0.11 Geometry of the chip (xGeometry), the default size of the disk is given by the chip.
+ */
+
+#ifndef FREERTOS_PLUS_FAT_PORTABLE_SPANSION_S25FL1XXK_INCLUDE_MA_SPANSION_S25FL1XXK_CONTEXT_H_
+#define FREERTOS_PLUS_FAT_PORTABLE_SPANSION_S25FL1XXK_INCLUDE_MA_SPANSION_S25FL1XXK_CONTEXT_H_
+
+#include "ma_spansion_s25fl1xxk_driver_config.h"
+
+#if(spansionSPI_PORT == spansionSPI_PORT_HOST_SIMULATOR)
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+#else
+#include "FreeRTOS.h"
+#include "os_task.h"
+#include "os_semphr.h"
+#endif
+
+#include "ma_spansion_s25fl1xxk_transport.h"
+#include "ma_spansion_s25fl1xxk_cache.h"
+#include "ma_spansion_s25fl1xxk_trace.h"
+#include "ma_spansion_s25fl1xxk_ftl.h"
+#include "ma_spansion_s25fl1xxk_sfdp.h"
+
+/* Disk configuration of FF_SPIDiskInitEx(). */
+typedef struct {
+	const spansion_transport_t	*pxTransport;		/* Bus / _CS binding (NULL: pxSpansionSPI_GetTransport(0)). */
+	uint32_t					ulSectorCount;		/* Size of the disk in FAT sectors (0: the chip without the log of the flash translation layer). */
+} spansion_disk_config_t;
+
+/* Sector erase or page program which may still be in progress. */
+typedef struct {
+	uint8_t		Operation;
+	uint32_t	Address;
+	uint32_t	Length;
+} spansion_pending_t;
+
+#if(cacheREAD_AHEAD_ASYNC)
+/* Sector read left running by prvSpansionSPI_SectorReadStart(). */
+typedef struct {
+	spansion_transfer_t	Transfer;		/* Valid until the end of the data phase. */
+	BaseType_t			Active;			/* The bus is taken by the read. */
+	BaseType_t			Suspended;		/* An erase / program is suspended for the read. */
+} spansion_async_read_t;
+#endif
+
+/* Cache and device statistics of a disk (vSpansionSPI_GetStats()). */
+typedef struct {
+	cache_stats_t		Area[cacheAREA_COUNT];					/* FAT / data area. */
+	uint32_t			Evictions[INCOMPATIBLE + 1];			/* Replaced entries by their state (cache_state_t). */
+	uint32_t			WriteBacks;								/* Dirty entries written back. */
+	uint32_t			BlockFlushes;							/* Write backs with one block erase. */
+	uint32_t			PagePrograms;
+	uint32_t			SectorErases;
+	uint32_t			BlockErases;
+	uint32_t			Suspends;								/* Erases / programs suspended by reads. */
+	uint64_t			BusyWaitTime;							/* Time spent polling the busy bit [us]. */
+	cache_latency_t		SectorRead;								/* Whole line fills. */
+	uint32_t			PartialFills;							/* Reads of FAT sectors into partially filled lines. */
+	uint32_t			PartialFillSectors;						/* FAT sectors read by them. */
+	cache_latency_t		SectorWrite;							/* Page programs of a sector (blocking). */
+	cache_latency_t		SectorErase;							/* Sector erases (blocking). */
+	cache_latency_t		BlockErase;
+	uint32_t			FtlRecords;								/* FAT sectors appended to the log. */
+	uint32_t			FtlCopies;								/* Live records copied forward by the log collection. */
+	uint32_t			FtlCheckpoints;							/* Lines rewritten in place by the log collection. */
+	uint32_t			FtlCollections;							/* Log sectors reclaimed. */
+	uint32_t			DiscardedLines;							/* Lines queued for erase by xSpansionSPI_Discard(). */
+	uint32_t			PreErases;								/* Discarded lines erased by the write back task. */
+	uint32_t			ErasedFills;							/* Line fills / bulk compares of known erased lines (no read). */
+	uint32_t			ReadAheadLines;							/* Lines prefetched by the read-ahead. */
+	uint32_t			ReadAheadHits;							/* Prefetched lines read afterwards. */
+	uint32_t			ReadAheadWasted;						/* Prefetched lines replaced before they were read. */
+	uint32_t			Promotions;								/* Lines moved to the frequent list (cachePOLICY_ADAPTIVE). */
+	uint32_t			GhostHits;								/* Misses on the tag of a recently replaced line. */
+	uint32_t			PartitionMoves;							/* Entries moved to the other partition by ghost hits. */
+} spansion_stats_t;
+
+/* Write back task state. */
+typedef struct {
+	TaskHandle_t				Task;
+	cache_writeback_config_t	Config;
+	cache_writeback_status_t	Status;
+	BaseType_t					Draining;		/* Flushing from the high down to the low watermark. */
+} cache_writeback_t;
+
+struct xSPANSION_CONTEXT {
+	/* Device. */
+	spansion_disk_config_t		xConfig;
+	spansion_geometry_t			xGeometry;			/* Probed by the low level init. */
+	SemaphoreHandle_t			xMutex;				/* Recursive, serializes the accesses of the cache and the chip. */
+	BaseType_t					xChipEraseInProgress;
+	BaseType_t					xContinuousRead;	/* The chip is in 0xEB continuous read mode. */
+	spansion_pending_t			xPending;
+#if(cacheREAD_AHEAD_ASYNC)
+	spansion_async_read_t		xAsyncRead;
+#endif
+
+	/* Cache metadata, line data, tag hash index and partitions. */
+	cache_entry_t				xCache[cacheLINE_COUNT];
+	uint8_t						ucCacheLines[cacheLINE_COUNT][cacheLINE_SIZE];
+	cache_index_t				xCacheHash[cacheSPI_HASH_SIZE];
+	cache_partition_t			xCachePartition[cachePARTITION_COUNT];
+	cache_lru_t					xCacheDirty;		/* Dirty entries, Head: last written, Tail: oldest (write back task). */
+	cache_writeback_t			xWriteback;
+	spansion_stats_t			xStats;
+#if(cacheSPI_DISCARD_ENABLE)
+	cache_discard_t				xDiscard;
+#endif
+#if(cacheSPI_READ_AHEAD_LINES > 0)
+	cache_readahead_t			xReadAhead;
+#endif
+#if(spansionTRACE_RING_SIZE > 0)
+	spansion_trace_ring_t		xTrace;
+#endif
+#if(spansionFTL_LOG_SECTORS > 0)
+	spansion_ftl_t				xFtl;
+#endif
+
+#if(cacheSPI_BLOCK_ERASE_MIN_SECTORS > 0) && (cacheSPI_BLOCK_ERASE_COPY_SECTORS > 0)
+	/* Sectors saved before a block erase. */
+	uint8_t						ucBlockCopy[cacheSPI_BLOCK_ERASE_COPY_SECTORS][spansionSPI_SECTOR_SIZE];
+#endif
+};
+
+#endif /* FREERTOS_PLUS_FAT_PORTABLE_SPANSION_S25FL1XXK_INCLUDE_MA_SPANSION_S25FL1XXK_CONTEXT_H_ */
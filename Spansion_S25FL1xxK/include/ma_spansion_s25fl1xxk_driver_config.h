@@ -1,92 +1,343 @@
-/**
- * @file ma_spansion_s25fl1xxk_driver_config.h
- *
- * @brief FreeRTOS+FAT driver for Spansion S25FL1xxk SPI flash devices.
- * @author Lovas Szilrd <lovas.szilard@gmail.com>
- * @Version: 0.1
- * @note: initial version
- * @Date: 2017-03-26 8:00
- */
-
-#ifndef FREERTOS_PLUS_FAT_PORTABLE_SPANSION_S25FL1XXK_INCLUDE_MA_SPANSION_S25FL1XXK_DRIVER_CONFIG_H_
-#define FREERTOS_PLUS_FAT_PORTABLE_SPANSION_S25FL1XXK_INCLUDE_MA_SPANSION_S25FL1XXK_DRIVER_CONFIG_H_
-
-/* Cache related defs, typedefs and data structures. */
-#define cacheSPI_CACHE_SIZE (2)
-#define cacheSPI_CACHE_FAT_RESERVED_SIZE (1)
-
-#if ( cacheSPI_CACHE_SIZE < 1 || cacheSPI_CACHE_SIZE <= cacheSPI_CACHE_FAT_RESERVED_SIZE)
-#error "cacheSPI_CACHE_SIZE must be greater than 1 and cacheSPI_CACHE_FAT_RESERVED_SIZE less than cacheSPI_CACHE_SIZE."
-#endif
-
-#define cacheSPI_SECTOR_SIZE (4096)
-#define cacheLINE_SIZE (1 * cacheSPI_SECTOR_SIZE)
-
-#define spansionFAT_SECTOR_SIZE				512
-#define spansionSPI_SECTOR_SIZE				4096
-#define spansionSPI_PAGE_SIZE				256
-#define spansionSPI_SECTOR_COUNT			16384	/* 8 MByte */
-#define spansionSPI_IOMANAGER_CACHE_SIZE	(20 * spansionFAT_SECTOR_SIZE)
-#define spansionSPI_PARTITION_NUMBER		0
-#define spansionSPI_SIGNATURE				0xABBA1234
-#define spansionSPI_HIDDEN_SECTOR_COUNT		8
-#define spansionSPI_PRIMARY_PARTITIONS		1
-
-
-//#define traceSPI_FLASH_FFREAD_START(Address, FATSecCnt, Time)		vLoggingPrintf("r,%x,%d,%llu", Address, FATSecCnt, Time)
-//#define traceSPI_FLASH_FFREAD_END(Address, FATSecCnt, Time)			vLoggingPrintf(",%llu\r\n", Time)
-//#define traceSPI_FLASH_FFREAD_CHECK_START(Address, FATSecCnt, Time)	vLoggingPrintf("c,%x,%d,%llu", Address, FATSecCnt, Time)
-//#define traceSPI_FLASH_FFREAD_CHECK_END(Address, FATSecCnt, Time)	vLoggingPrintf(",%llu\r\n", Time)
-//#define traceSPI_FLASH_FFWRITE_START(Address, FATSecCnt, Time)
-//#define traceSPI_FLASH_FFWRITE_END(Address, FATSecCnt, Time)
-//#define traceSPI_FLASH_WRITE_SECTOR_START(Address, FATSecCnt, Time)	vLoggingPrintf("w,%x,%d,%llu", Address, FATSecCnt, Time)
-//#define traceSPI_FLASH_WRITE_SECTOR_END(Address, FATSecCnt, Time)	vLoggingPrintf(",%llu\r\n", Time)
-//#define traceSPI_FLASH_ERASE_SECTOR_START(Address, FATSecCnt, Time)	vLoggingPrintf("e,%x,%d,%llu", Address, FATSecCnt, Time)
-//#define traceSPI_FLASH_ERASE_SECTOR_END(Address, FATSecCnt, Time)	vLoggingPrintf(",%llu\r\n", Time)
-
-#define traceSPI_FLASH_FFREAD_START(Address, FATSecCnt, Time)
-#define traceSPI_FLASH_FFREAD_END(Address, FATSecCnt, Time)
-#define traceSPI_FLASH_FFREAD_CHECK_START(Address, FATSecCnt, Time)
-#define traceSPI_FLASH_FFREAD_CHECK_END(Address, FATSecCnt, Time)
-#define traceSPI_FLASH_FFWRITE_START(Address, FATSecCnt, Time)
-#define traceSPI_FLASH_FFWRITE_END(Address, FATSecCnt, Time)
-#define traceSPI_FLASH_WRITE_SECTOR_START(Address, FATSecCnt, Time)
-#define traceSPI_FLASH_WRITE_SECTOR_END(Address, FATSecCnt, Time)
-#define traceSPI_FLASH_ERASE_SECTOR_START(Address, FATSecCnt, Time)
-#define traceSPI_FLASH_ERASE_SECTOR_END(Address, FATSecCnt, Time)
-
-
-//#define traceSPI_FLASH_FFREAD_START(Address, FATSecCnt, Time)		vLoggingPrintf("RF,%x,%d,%llu,%llu\r\n", Address, FATSecCnt, Time, Time)
-//#define traceSPI_FLASH_FFREAD_END(Address, FATSecCnt, Time)
-//#define traceSPI_FLASH_FFWRITE_START(Address, FATSecCnt, Time)		vLoggingPrintf("WF,%x,%d,%llu,%llu\r\n", Address, FATSecCnt, Time, Time)
-//#define traceSPI_FLASH_FFWRITE_END(Address, FATSecCnt, Time)
-
-//#define traceSPI_FLASH_READ_SECTOR_START(Address, FATSecCnt, Time)	vLoggingPrintf("r,%x,%d,%llu", Address, FATSecCnt, Time)
-//#define traceSPI_FLASH_READ_SECTOR_END(Address, FATSecCnt, Time)	vLoggingPrintf(",%llu\r\n", Time)
-//#define traceSPI_FLASH_WRITE_SECTOR_START(Address, FATSecCnt, Time)	vLoggingPrintf("w,%x,%d,%llu", Address, FATSecCnt, Time)
-//#define traceSPI_FLASH_WRITE_SECTOR_END(Address, FATSecCnt, Time)	vLoggingPrintf(",%llu\r\n", Time)
-//#define traceSPI_FLASH_ERASE_SECTOR_START(Address, FATSecCnt, Time)	vLoggingPrintf("e,%x,%d,%llu", Address, FATSecCnt, Time)
-//#define traceSPI_FLASH_ERASE_SECTOR_END(Address, FATSecCnt, Time)	vLoggingPrintf(",%llu\r\n", Time)
-
-//#define traceSPI_FLASH_FFREAD_START(Address, FATSecCnt, Time)
-#define traceSPI_FLASH_FFREAD_END(Address, FATSecCnt, Time)
-//#define traceSPI_FLASH_FFWRITE_START(Address, FATSecCnt, Time)
-#define traceSPI_FLASH_FFWRITE_END(Address, FATSecCnt, Time)
-
-//#define traceSPI_FLASH_FFREAD_START2(Area, Address, FATSecCnt)
-//#define traceSPI_FLASH_FFWRITE_START2(Area, Address, FATSecCnt)
-
-#define traceSPI_FLASH_FFREAD_START2(Area, Address, FATSecCnt)		vLoggingPrintf("R,%c,%d,%d,\r\n", Area, Address, FATSecCnt)
-#define traceSPI_FLASH_FFWRITE_START2(Area, Address, FATSecCnt)		vLoggingPrintf("W,%c,%d,%d,\r\n", Area, Address, FATSecCnt)
-
-
-#define traceSPI_FLASH_READ_SECTOR_START(Address, FATSecCnt, Time)
-#define traceSPI_FLASH_READ_SECTOR_END(Address, FATSecCnt, Time)
-#define traceSPI_FLASH_WRITE_SECTOR_START(Address, FATSecCnt, Time)
-#define traceSPI_FLASH_WRITE_SECTOR_END(Address, FATSecCnt, Time)
-#define traceSPI_FLASH_ERASE_SECTOR_START(Address, FATSecCnt, Time)
-#define traceSPI_FLASH_ERASE_SECTOR_END(Address, FATSecCnt, Time)
-
-
-
-#endif /* FREERTOS_PLUS_FAT_PORTABLE_SPANSION_S25FL1XXK_INCLUDE_MA_SPANSION_S25FL1XXK_DRIVER_CONFIG_H_ */
+/**
+ * @file ma_spansion_s25fl1xxk_driver_config.h
+ *
+ * @brief FreeRTOS+FAT driver for Spansion S25FL1xxk SPI flash devices.
+ * @author Lovas Szilárd <lovas.szilard@gmail.com>
+ * @Version: 0.13
+ * @note: initial version
+ * @Date: 2017-03-26 8:00
+ * @Date: 2017-07-10 10:00
+ * - 0.2 spansionSPI_DEVICE_COUNT
+ * @Date: 2017-07-17 10:00
+ * - 0.3 Block erase of the write back (cacheSPI_BLOCK_ERASE_MIN_SECTORS).
+ * @Date: 2017-07-24 10:00
+ * - 0.4 cacheSTATS_ENABLE
+ * @Date: 2017-07-31 10:00
+ * - 0.5 Binary trace ring (spansionTRACE_RING_SIZE) instead of vLoggingPrintf() in FFRead / FFWrite.
+ * @Date: 2017-08-14 10:00
+ * - 0.6 Flash translation layer (spansionFTL_LOG_SECTORS, spansionFTL_MAX_DIRTY_SECTORS).
+ * @Date: 2017-08-21 10:00
+ * - 0.7 Discard: known erased sectors, pre-erase of the discarded ones (cacheSPI_DISCARD_ENABLE).
+ * @Date: 2017-08-28 10:00
+ * - 0.8 Sequential read-ahead of the data area (cacheSPI_READ_AHEAD_LINES).
+ * @Date: 2017-09-04 10:00
+ * - 0.9 Partial line fills (cacheSPI_PARTIAL_FILL_ENABLE).
+ * @Date: 2017-09-11 10:00
+ * - 0.10 Unified buffering (spansionSPI_UNIFIED_CACHE): the IOManager buffers are given to the driver cache.
+ * @Date: 2017-09-18 10:00
+ * - 0.11 Fast format on an erased disk (cacheSPI_FAST_FORMAT_ENABLE).
+ * @Date: 2017-09-25 10:00
+ * - 0.12 Adaptive replacement policy (cacheSPI_REPLACEMENT_POLICY, cacheSPI_PARTITION_MIN_SIZE).
+ * @Date: 2017-10-02 10:00
+ * - 0.13 Chip identification (spansionSPI_PROBE_ENABLE), spansionSPI_SECTOR_COUNT is the largest chip of the build.
+ */
+
+#ifndef FREERTOS_PLUS_FAT_PORTABLE_SPANSION_S25FL1XXK_INCLUDE_MA_SPANSION_S25FL1XXK_DRIVER_CONFIG_H_
+#define FREERTOS_PLUS_FAT_PORTABLE_SPANSION_S25FL1XXK_INCLUDE_MA_SPANSION_S25FL1XXK_DRIVER_CONFIG_H_
+
+/* Portable layer selection. */
+#define spansionSPI_PORT_HERCULES_BIT_BANGING	1	/* TI Hercules, GPIO bit-banging on spiREG5. */
+#define spansionSPI_PORT_HOST_SIMULATOR			2	/* Linux host, emulated S25FL1xxK device. */
+#define spansionSPI_PORT_HERCULES_MIBSPI_DMA	3	/* TI Hercules, SPI5 module with DMA data phases. */
+
+#ifndef spansionSPI_PORT
+#define spansionSPI_PORT	spansionSPI_PORT_HERCULES_BIT_BANGING
+#endif
+
+/* Number of flash chips of the port (pxSpansionSPI_GetTransport()). The bus / _CS
+binding of the chips is given by the device table of the port:
+spansionSPI_HERCULES_DEVICES { {SPI module, _CS pin}, ... } on the Hercules ports. */
+#ifndef spansionSPI_DEVICE_COUNT
+#define spansionSPI_DEVICE_COUNT	1
+#endif
+
+/* Chip identification: the low level init reads the JEDEC ID and the SFDP of the chip and takes
+its size, page size, erase, program and read commands and address length from them (0: the
+S25FL1xxK command set with spansionSPI_SECTOR_COUNT sectors, no identification). */
+#ifndef spansionSPI_PROBE_ENABLE
+#define spansionSPI_PROBE_ENABLE	(1)
+#endif
+
+/* Size of the largest chip the build supports [FAT sectors]. The known erased bitmap and the
+array of the simulator are sized by it, a larger chip is used up to this size. The default is
+8 MByte (S25FL164K), 65536 is 32 MByte. */
+#ifndef spansionSPI_SECTOR_COUNT
+#define spansionSPI_SECTOR_COUNT	16384
+#endif
+
+#if ( spansionSPI_SECTOR_COUNT < 256 || spansionSPI_SECTOR_COUNT > 4194304 )
+#error "spansionSPI_SECTOR_COUNT must be between 256 (128 kB) and 4194304 (2 GB)."
+#endif
+
+/* Cache related defs, typedefs and data structures. */
+#ifndef cacheSPI_CACHE_SIZE
+#define cacheSPI_CACHE_SIZE (2)
+#endif
+#ifndef cacheSPI_CACHE_FAT_RESERVED_SIZE
+#define cacheSPI_CACHE_FAT_RESERVED_SIZE (1)
+#endif
+
+#if ( cacheSPI_CACHE_SIZE < 1 || cacheSPI_CACHE_SIZE <= cacheSPI_CACHE_FAT_RESERVED_SIZE)
+#error "cacheSPI_CACHE_SIZE must be greater than 1 and cacheSPI_CACHE_FAT_RESERVED_SIZE less than cacheSPI_CACHE_SIZE."
+#endif
+
+#if ( cacheSPI_CACHE_SIZE > 32767 )
+#error "cacheSPI_CACHE_SIZE must be less than 32768."
+#endif
+
+/* Number of the tag hash buckets (power of two, at least cacheSPI_CACHE_SIZE is advised). */
+#ifndef cacheSPI_HASH_SIZE
+#define cacheSPI_HASH_SIZE (2)
+#endif
+
+#if ( cacheSPI_HASH_SIZE < 1 || (cacheSPI_HASH_SIZE & (cacheSPI_HASH_SIZE - 1)) != 0 )
+#error "cacheSPI_HASH_SIZE must be a power of two."
+#endif
+
+/* Data area reads of at least this many FAT sectors bypass the cache and are
+read with a single command directly into the destination (0: disabled). */
+#ifndef cacheSPI_STREAM_READ_MIN_SECTORS
+#define cacheSPI_STREAM_READ_MIN_SECTORS (8)
+#endif
+
+/* Data area writes covering whole 4 kB sectors are programmed directly from the source. */
+#ifndef cacheSPI_BULK_WRITE_ENABLE
+#define cacheSPI_BULK_WRITE_ENABLE (1)
+#endif
+
+/* Lines are filled FAT sector by FAT sector: a read miss reads the requested FAT sectors of
+the line, a write miss the written one. The rest of the line is read by the next read miss
+in the line, or before the line is erased (0: a miss reads the whole 4 kB line). */
+#ifndef cacheSPI_PARTIAL_FILL_ENABLE
+#define cacheSPI_PARTIAL_FILL_ENABLE (1)
+#endif
+
+/* Write back with 64 kB block erases: a block is erased in one step if at least this many
+of its 16 sectors have to be erased (0: disabled). A block erase (tBE ~500 ms) replaces
+about ten sector erases (tSE ~50 ms), the other sectors of the block are reprogrammed. */
+#ifndef cacheSPI_BLOCK_ERASE_MIN_SECTORS
+#define cacheSPI_BLOCK_ERASE_MIN_SECTORS (12)
+#endif
+
+/* Sectors of the block that are neither cached nor blank are saved before the block
+erase into a buffer of this many sectors (per disk). More such sectors: sector erases. */
+#ifndef cacheSPI_BLOCK_ERASE_COPY_SECTORS
+#define cacheSPI_BLOCK_ERASE_COPY_SECTORS (1)
+#endif
+
+#if ( cacheSPI_BLOCK_ERASE_MIN_SECTORS > 16 )
+#error "cacheSPI_BLOCK_ERASE_MIN_SECTORS must be less than or equal to the number of sectors of a block (16)."
+#endif
+
+/* Cache and device statistics, latency histograms (vSpansionSPI_GetStats()). */
+#ifndef cacheSTATS_ENABLE
+#define cacheSTATS_ENABLE (1)
+#endif
+
+/* Number of events of the binary trace ring of a disk (power of two, 0: disabled). */
+#ifndef spansionTRACE_RING_SIZE
+#define spansionTRACE_RING_SIZE (256)
+#endif
+
+/* Number of entries searched from the LRU end for a clean replacement victim. The adaptive
+policy takes the cheapest one of them: INVALID, VALID, MODIFIED, then INCOMPATIBLE. */
+#ifndef cacheSPI_CLEAN_VICTIM_SCAN
+#define cacheSPI_CLEAN_VICTIM_SCAN (4)
+#endif
+
+/* Replacement policy of the cache partitions.
+cachePOLICY_LRU: one LRU list per partition, the partitions keep their size.
+cachePOLICY_ADAPTIVE: scan resistant, ARC like. A new line enters the recent list, it is moved
+to the frequent list when one of its FAT sectors is read again. The tags of the replaced lines
+are kept in ghost lists, a miss on a ghost tag moves the target size of the recent list and takes
+an entry from the other partition (down to cacheSPI_PARTITION_MIN_SIZE entries). The time stamp of
+an entry is only taken by the writes (age of the write back). */
+#define cachePOLICY_LRU			0
+#define cachePOLICY_ADAPTIVE	1
+
+#ifndef cacheSPI_REPLACEMENT_POLICY
+#define cacheSPI_REPLACEMENT_POLICY cachePOLICY_LRU
+#endif
+#ifndef cacheSPI_PARTITION_MIN_SIZE
+#define cacheSPI_PARTITION_MIN_SIZE (1)
+#endif
+
+#if ( cacheSPI_PARTITION_MIN_SIZE < 1 )
+#error "cacheSPI_PARTITION_MIN_SIZE must be at least 1."
+#endif
+
+/* Log-structured flash translation layer under the cache: number of 4 kB log sectors
+placed after the disk (0: disabled, otherwise 4..1024). Write backs of a few changed
+FAT sectors that would need a sector erase are appended to the log. The default size
+of the disk is reduced by the log, so enabling it needs a new format. */
+#ifndef spansionFTL_LOG_SECTORS
+#define spansionFTL_LOG_SECTORS (0)
+#endif
+
+/* Write backs of at most this many changed FAT sectors of a line go to the log (1..7). */
+#ifndef spansionFTL_MAX_DIRTY_SECTORS
+#define spansionFTL_MAX_DIRTY_SECTORS (2)
+#endif
+
+#if ( spansionFTL_LOG_SECTORS != 0 && (spansionFTL_LOG_SECTORS < 4 || spansionFTL_LOG_SECTORS > 1024) )
+#error "spansionFTL_LOG_SECTORS must be 0 or between 4 and 1024."
+#endif
+
+#if ( spansionFTL_MAX_DIRTY_SECTORS < 1 || spansionFTL_MAX_DIRTY_SECTORS > 7 )
+#error "spansionFTL_MAX_DIRTY_SECTORS must be between 1 and 7 (records of a log sector)."
+#endif
+
+/* Discarded sectors (xSpansionSPI_Discard()) are erased by the write back task when it is
+idle, a bitmap per disk tells the erased 4 kB sectors: their lines are filled without read
+and written without erase (0: discarded lines are only dropped from the cache). */
+#ifndef cacheSPI_DISCARD_ENABLE
+#define cacheSPI_DISCARD_ENABLE (1)
+#endif
+
+/* Fast format: FF_SPIDiskInitEx() / vSpansionSPI_PartitionAndFormatDisk() erase the disk before
+FF_Partition() / FF_Format(), with one chip erase if the disk fills the chip, with block and sector
+erases otherwise; the sectors already known erased (e.g. vSpansionSPI_ChipErase() before) are
+skipped. The FAT and directory lines are then built in the cache without read and only their pages
+that are not blank are programmed, the later writes of the disk need no erase until a sector is
+rewritten. The erase takes longer (tCE ~40 s) than the read-modify-write of the FAT and directory
+sectors, it pays off when the disk is filled after the format, e.g. on a production line
+(0: the format is written through the read-modify-write path of the cache). It needs the bitmap
+of the erased sectors of cacheSPI_DISCARD_ENABLE. */
+#ifndef cacheSPI_FAST_FORMAT_ENABLE
+#define cacheSPI_FAST_FORMAT_ENABLE (0)
+#endif
+
+#if ( cacheSPI_FAST_FORMAT_ENABLE && !cacheSPI_DISCARD_ENABLE )
+#error "cacheSPI_FAST_FORMAT_ENABLE needs cacheSPI_DISCARD_ENABLE (bitmap of the erased sectors)."
+#endif
+
+/* Sequential read-ahead: after consecutive misses of the data area lines, at most this many
+following lines are prefetched into the data partition (0: disabled). The window is also
+limited to a quarter of the data partition, so it can not push out the FAT / directory lines.
+Asynchronous transports (spansionSPI_CAP_ASYNC) read the next line after FFRead returns,
+otherwise the write back task reads the window when it is idle. */
+#ifndef cacheSPI_READ_AHEAD_LINES
+#define cacheSPI_READ_AHEAD_LINES (4)
+#endif
+
+/* Unified buffering: the driver cache is the buffer pool of the disk. The IOManager of
+FreeRTOS+FAT keeps only spansionSPI_IOMANAGER_MIN_BUFFERS sector buffers (FreeRTOS+FAT holds
+a few of them at the same time), the memory of the other IOManager buffers is added to the
+data partition of the driver cache as whole lines (0: the IOManager has its own
+spansionSPI_IOMANAGER_BUFFERS buffers). */
+#ifndef spansionSPI_UNIFIED_CACHE
+#define spansionSPI_UNIFIED_CACHE (0)
+#endif
+#ifndef spansionSPI_IOMANAGER_MIN_BUFFERS
+#define spansionSPI_IOMANAGER_MIN_BUFFERS (4)
+#endif
+
+#if ( spansionSPI_IOMANAGER_MIN_BUFFERS < 2 )
+#error "spansionSPI_IOMANAGER_MIN_BUFFERS must be at least 2 (FreeRTOS+FAT IOManager)."
+#endif
+
+/* Write back task (started by xSpansionSPI_StartWriteback()). */
+#define cacheSPI_WRITEBACK_TASK_STACK_SIZE	(configMINIMAL_STACK_SIZE * 2)
+#define cacheSPI_WRITEBACK_TASK_PRIORITY	(tskIDLE_PRIORITY + 1)
+
+#define cacheSPI_SECTOR_SIZE (4096)
+#define cacheLINE_SIZE (1 * cacheSPI_SECTOR_SIZE)
+#define cacheSECTORS_PER_LINE (cacheLINE_SIZE / spansionFAT_SECTOR_SIZE)
+
+/* Sector buffers of the IOManager, lines of the driver cache. */
+#define spansionSPI_IOMANAGER_BUFFERS		20
+#if(spansionSPI_UNIFIED_CACHE)
+#define spansionSPI_IOMANAGER_CACHE_SIZE	(spansionSPI_IOMANAGER_MIN_BUFFERS * spansionFAT_SECTOR_SIZE)
+#define cacheUNIFIED_LINES					(((spansionSPI_IOMANAGER_BUFFERS - spansionSPI_IOMANAGER_MIN_BUFFERS) * spansionFAT_SECTOR_SIZE) / cacheLINE_SIZE)
+#else
+#define spansionSPI_IOMANAGER_CACHE_SIZE	(spansionSPI_IOMANAGER_BUFFERS * spansionFAT_SECTOR_SIZE)
+#define cacheUNIFIED_LINES					0
+#endif
+#define cacheLINE_COUNT						(cacheSPI_CACHE_SIZE + cacheUNIFIED_LINES)
+
+#if ( cacheLINE_COUNT > 32767 )
+#error "cacheSPI_CACHE_SIZE and the lines of the unified buffering must be less than 32768."
+#endif
+
+#define spansionFAT_SECTOR_SIZE				512
+#define spansionSPI_SECTOR_SIZE				4096
+#define spansionSPI_PAGE_SIZE				256
+#define spansionSPI_PAGES_PER_SECTOR		(spansionSPI_SECTOR_SIZE / spansionSPI_PAGE_SIZE)
+#define spansionSPI_ALL_PAGES				(uint16_t)((1UL << spansionSPI_PAGES_PER_SECTOR) - 1)
+#define spansionSPI_BLOCK_SIZE				65536
+#define spansionSPI_SECTORS_PER_BLOCK		(spansionSPI_BLOCK_SIZE / spansionSPI_SECTOR_SIZE)
+#define spansionSPI_DISK_SECTOR_COUNT(ChipSize)	((ChipSize) / spansionFAT_SECTOR_SIZE - spansionFTL_LOG_SECTORS * (spansionSPI_SECTOR_SIZE / spansionFAT_SECTOR_SIZE))	/* Default size of the disks. */
+#define spansionSPI_PARTITION_NUMBER		0
+#define spansionSPI_SIGNATURE				0xABBA1234
+#define spansionSPI_HIDDEN_SECTOR_COUNT		8
+#define spansionSPI_PRIMARY_PARTITIONS		1
+
+
+//#define traceSPI_FLASH_FFREAD_START(Address, FATSecCnt, Time)		vLoggingPrintf("r,%x,%d,%llu", Address, FATSecCnt, Time)
+//#define traceSPI_FLASH_FFREAD_END(Address, FATSecCnt, Time)			vLoggingPrintf(",%llu\r\n", Time)
+//#define traceSPI_FLASH_FFREAD_CHECK_START(Address, FATSecCnt, Time)	vLoggingPrintf("c,%x,%d,%llu", Address, FATSecCnt, Time)
+//#define traceSPI_FLASH_FFREAD_CHECK_END(Address, FATSecCnt, Time)	vLoggingPrintf(",%llu\r\n", Time)
+//#define traceSPI_FLASH_FFWRITE_START(Address, FATSecCnt, Time)
+//#define traceSPI_FLASH_FFWRITE_END(Address, FATSecCnt, Time)
+//#define traceSPI_FLASH_WRITE_SECTOR_START(Address, FATSecCnt, Time)	vLoggingPrintf("w,%x,%d,%llu", Address, FATSecCnt, Time)
+//#define traceSPI_FLASH_WRITE_SECTOR_END(Address, FATSecCnt, Time)	vLoggingPrintf(",%llu\r\n", Time)
+//#define traceSPI_FLASH_ERASE_SECTOR_START(Address, FATSecCnt, Time)	vLoggingPrintf("e,%x,%d,%llu", Address, FATSecCnt, Time)
+//#define traceSPI_FLASH_ERASE_SECTOR_END(Address, FATSecCnt, Time)	vLoggingPrintf(",%llu\r\n", Time)
+
+#define traceSPI_FLASH_FFREAD_START(Address, FATSecCnt, Time)
+#define traceSPI_FLASH_FFREAD_END(Address, FATSecCnt, Time)
+#define traceSPI_FLASH_FFREAD_CHECK_START(Address, FATSecCnt, Time)
+#define traceSPI_FLASH_FFREAD_CHECK_END(Address, FATSecCnt, Time)
+#define traceSPI_FLASH_FFWRITE_START(Address, FATSecCnt, Time)
+#define traceSPI_FLASH_FFWRITE_END(Address, FATSecCnt, Time)
+#define traceSPI_FLASH_WRITE_SECTOR_START(Address, FATSecCnt, Time)
+#define traceSPI_FLASH_WRITE_SECTOR_END(Address, FATSecCnt, Time)
+#define traceSPI_FLASH_ERASE_SECTOR_START(Address, FATSecCnt, Time)
+#define traceSPI_FLASH_ERASE_SECTOR_END(Address, FATSecCnt, Time)
+
+
+//#define traceSPI_FLASH_FFREAD_START(Address, FATSecCnt, Time)		vLoggingPrintf("RF,%x,%d,%llu,%llu\r\n", Address, FATSecCnt, Time, Time)
+//#define traceSPI_FLASH_FFREAD_END(Address, FATSecCnt, Time)
+//#define traceSPI_FLASH_FFWRITE_START(Address, FATSecCnt, Time)		vLoggingPrintf("WF,%x,%d,%llu,%llu\r\n", Address, FATSecCnt, Time, Time)
+//#define traceSPI_FLASH_FFWRITE_END(Address, FATSecCnt, Time)
+
+//#define traceSPI_FLASH_READ_SECTOR_START(Address, FATSecCnt, Time)	vLoggingPrintf("r,%x,%d,%llu", Address, FATSecCnt, Time)
+//#define traceSPI_FLASH_READ_SECTOR_END(Address, FATSecCnt, Time)	vLoggingPrintf(",%llu\r\n", Time)
+//#define traceSPI_FLASH_WRITE_SECTOR_START(Address, FATSecCnt, Time)	vLoggingPrintf("w,%x,%d,%llu", Address, FATSecCnt, Time)
+//#define traceSPI_FLASH_WRITE_SECTOR_END(Address, FATSecCnt, Time)	vLoggingPrintf(",%llu\r\n", Time)
+//#define traceSPI_FLASH_ERASE_SECTOR_START(Address, FATSecCnt, Time)	vLoggingPrintf("e,%x,%d,%llu", Address, FATSecCnt, Time)
+//#define traceSPI_FLASH_ERASE_SECTOR_END(Address, FATSecCnt, Time)	vLoggingPrintf(",%llu\r\n", Time)
+
+//#define traceSPI_FLASH_FFREAD_START(Address, FATSecCnt, Time)
+#define traceSPI_FLASH_FFREAD_END(Address, FATSecCnt, Time)
+//#define traceSPI_FLASH_FFWRITE_START(Address, FATSecCnt, Time)
+#define traceSPI_FLASH_FFWRITE_END(Address, FATSecCnt, Time)
+
+//#define traceSPI_FLASH_FFREAD_START2(Area, Address, FATSecCnt)
+//#define traceSPI_FLASH_FFWRITE_START2(Area, Address, FATSecCnt)
+
+//#define traceSPI_FLASH_FFREAD_START2(Area, Address, FATSecCnt)		vLoggingPrintf("R,%c,%d,%d,\r\n", Area, Address, FATSecCnt)
+//#define traceSPI_FLASH_FFWRITE_START2(Area, Address, FATSecCnt)		vLoggingPrintf("W,%c,%d,%d,\r\n", Area, Address, FATSecCnt)
+
+/* Binary trace ring of the disk (uxSpansionSPI_TraceDrain()), pxContext is the disk context in FFRead / FFWrite / discard. */
+#if(spansionTRACE_RING_SIZE > 0)
+#define traceSPI_FLASH_FFREAD_START2(Area, Address, FATSecCnt)		prvSpansionSPI_TraceEvent(&pxContext->xTrace, spansionTRACE_OP_READ, Area, Address, FATSecCnt)
+#define traceSPI_FLASH_FFWRITE_START2(Area, Address, FATSecCnt)		prvSpansionSPI_TraceEvent(&pxContext->xTrace, spansionTRACE_OP_WRITE, Area, Address, FATSecCnt)
+#define traceSPI_FLASH_DISCARD(Area, Address, FATSecCnt)			prvSpansionSPI_TraceEvent(&pxContext->xTrace, spansionTRACE_OP_DISCARD, Area, Address, FATSecCnt)
+#else
+#define traceSPI_FLASH_FFREAD_START2(Area, Address, FATSecCnt)
+#define traceSPI_FLASH_FFWRITE_START2(Area, Address, FATSecCnt)
+#define traceSPI_FLASH_DISCARD(Area, Address, FATSecCnt)
+#endif
+
+
+#define traceSPI_FLASH_READ_SECTOR_START(Address, FATSecCnt, Time)
+#define traceSPI_FLASH_READ_SECTOR_END(Address, FATSecCnt, Time)
+#define traceSPI_FLASH_WRITE_SECTOR_START(Address, FATSecCnt, Time)
+#define traceSPI_FLASH_WRITE_SECTOR_END(Address, FATSecCnt, Time)
+#define traceSPI_FLASH_ERASE_SECTOR_START(Address, FATSecCnt, Time)
+#define traceSPI_FLASH_ERASE_SECTOR_END(Address, FATSecCnt, Time)
+
+
+
+#endif /* FREERTOS_PLUS_FAT_PORTABLE_SPANSION_S25FL1XXK_INCLUDE_MA_SPANSION_S25FL1XXK_DRIVER_CONFIG_H_ */
@@ -0,0 +1,86 @@
+/**
+ * @file ma_spansion_s25fl1xxk_ftl.h
+ *
+ * @brief Log-structured flash translation layer of the Spansion S25FL1xxk FreeRTOS+FAT driver.
+ * Write backs changing only a few FAT sectors of a line (hot FAT / directory sectors) are
+ * appended as 512 byte records to a log of pre-erased 4 kB sectors placed after the disk,
+ * instead of erasing the home sector of the line. The RAM map tells the live record of
+ * each logged FAT sector, reads of the home sectors are patched with them. The live records
+ * are chained by home line in a small hash, so the lines without records are passed over
+ * without scanning the map. The garbage
+ * collection reclaims the oldest log sector: its few live records are copied to the head
+ * of the log, or their lines are rewritten in place (checkpoint). The map is rebuilt at
+ * mount from the record headers of the log sectors.
+ *
+ * Log sector: page 0 holds the headers of the 7 records, record r is stored at
+ * 256 + r * 512, page 15 is not used. A record is committed by its header (programmed
+ * after the data), the newest record of a FAT sector wins. Erasing the home sector of a
+ * logged FAT sector kills its live record (Live word programmed to 0).
+ * @author Lovas Szilárd <lovas.szilard@gmail.com>
+ * @version: 0.1
+ * @date: 2017-08-14 10:00
+ * - initial version
+ */
+
+#ifndef FREERTOS_PLUS_FAT_PORTABLE_SPANSION_S25FL1XXK_INCLUDE_MA_SPANSION_S25FL1XXK_FTL_H_
+#define FREERTOS_PLUS_FAT_PORTABLE_SPANSION_S25FL1XXK_INCLUDE_MA_SPANSION_S25FL1XXK_FTL_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include "FreeRTOS.h"
+#include "ma_spansion_s25fl1xxk_driver_config.h"
+#include "ma_spansion_s25fl1xxk_cache.h"
+
+#define spansionFTL_SLOTS_PER_SECTOR	7
+#define spansionFTL_SLOT_COUNT			(spansionFTL_LOG_SECTORS * spansionFTL_SLOTS_PER_SECTOR)
+#define spansionFTL_MAGIC				0x46544c31UL	/* "FTL1" */
+#define spansionFTL_HASH_SIZE			spansionFTL_SLOT_COUNT	/* Buckets of the home lines (at most one live record per bucket on average). */
+#define spansionFTL_NO_SLOT				0xffffU			/* End of a hash chain. */
+
+/* Slot states of the map, other values: FAT sector address of the live record. */
+#define spansionFTL_SLOT_FREE			0xffffffffUL	/* Erased, not written since. */
+#define spansionFTL_SLOT_DEAD			0xfffffffeUL	/* Superseded, killed or not known to be erased. */
+#define spansionFTL_IS_LIVE(Slot)		((Slot) < spansionFTL_SLOT_DEAD)
+
+/* Record header on the flash, 16 bytes (native byte order). */
+typedef struct {
+	uint32_t	Address;		/* SPI address of the FAT sector. */
+	uint32_t	Sequence;		/* Order of the records. */
+	uint32_t	Check;			/* Address ^ Sequence ^ spansionFTL_MAGIC. */
+	uint32_t	Live;			/* 0xffffffff: live, programmed to 0 when the record is killed. */
+} spansion_ftl_header_t;
+
+#if(spansionFTL_LOG_SECTORS > 0)
+/* Log state: the slots from Tail to Head are in use, the log sectors are reclaimed from the tail. */
+typedef struct {
+	uint32_t	Slots[spansionFTL_SLOT_COUNT];	/* Map: spansionFTL_SLOT_xxx or the address of the live record. */
+	uint16_t	Hash[spansionFTL_HASH_SIZE];	/* First live slot of the home lines of the bucket (spansionFTL_NO_SLOT: none). */
+	uint16_t	Next[spansionFTL_SLOT_COUNT];	/* Next live slot on the same hash chain. */
+	uint32_t	Base;							/* SPI address of the log (after the disk). */
+	uint32_t	Sequence;						/* Sequence number of the next record. */
+	uint16_t	Head;							/* Next slot to be written. */
+	uint16_t	Tail;							/* First slot of the oldest log sector. */
+	uint16_t	Used;							/* Number of slots from the tail to the head. */
+	uint8_t		Line[spansionSPI_SECTOR_SIZE];	/* Buffer of the garbage collection. */
+} spansion_ftl_t;
+
+static void prvSpansionSPI_FtlInit(spansion_context_t *pxContext);
+static void prvSpansionSPI_FtlMount(spansion_context_t *pxContext);
+static BaseType_t prvSpansionSPI_FtlWriteBack(spansion_context_t *pxContext, cache_entry_t *pxEntry);
+static BaseType_t prvSpansionSPI_FtlCollect(spansion_context_t *pxContext, BaseType_t xWait);
+static void prvSpansionSPI_FtlOverlay(spansion_context_t *pxContext, uint8_t *pucDestination, uint32_t xSpiAddress, uint32_t ulLength);
+static void prvSpansionSPI_FtlDiscard(spansion_context_t *pxContext, uint32_t xSpiAddress, uint32_t ulLength);
+static uint32_t prvSpansionSPI_FtlLineLive(spansion_context_t *pxContext, uint32_t xSpiAddress);
+
+#define ftlWRITE_BACK(pxContext, pxEntry)								prvSpansionSPI_FtlWriteBack(pxContext, pxEntry)
+#define ftlOVERLAY(pxContext, pucDestination, xSpiAddress, ulLength)	prvSpansionSPI_FtlOverlay(pxContext, pucDestination, xSpiAddress, ulLength)
+#define ftlDISCARD(pxContext, xSpiAddress, ulLength)					prvSpansionSPI_FtlDiscard(pxContext, xSpiAddress, ulLength)
+#define ftlLINE_LIVE(pxContext, xSpiAddress)							prvSpansionSPI_FtlLineLive(pxContext, xSpiAddress)
+#else
+#define ftlWRITE_BACK(pxContext, pxEntry)								(pdFALSE)
+#define ftlOVERLAY(pxContext, pucDestination, xSpiAddress, ulLength)
+#define ftlDISCARD(pxContext, xSpiAddress, ulLength)
+#define ftlLINE_LIVE(pxContext, xSpiAddress)							(0)
+#endif
+
+#endif /* FREERTOS_PLUS_FAT_PORTABLE_SPANSION_S25FL1XXK_INCLUDE_MA_SPANSION_S25FL1XXK_FTL_H_ */
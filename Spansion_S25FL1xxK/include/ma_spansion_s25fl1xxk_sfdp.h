@@ -0,0 +1,78 @@
+/**
+ * @file ma_spansion_s25fl1xxk_sfdp.h
+ *
+ * @brief Chip identification of the Spansion S25FL1xxk FreeRTOS+FAT driver.
+ * The low level init reads the JEDEC ID and the Serial Flash Discoverable Parameters
+ * (JESD216, SFDP) of the chip and sets the geometry of the disk: the size of the chip,
+ * the page size, the erase and program commands, the fastest read command supported by
+ * both the chip and the transport, and the address length. Parts above 16 MB are
+ * addressed with the 4-byte address commands (JESD216B 4-byte address instruction
+ * table, or the S25FL-S / S25FL-L command set), so the chip never leaves the 3-byte
+ * address mode the boot loader expects.
+ * Without SFDP the S25FL1xxK command set is used with the size given by the JEDEC ID.
+ * @author Lovas Szilárd <lovas.szilard@gmail.com>
+ * @version: 0.1
+ * @date: 2017-10-02 10:00
+ * - initial version
+ */
+
+#ifndef FREERTOS_PLUS_FAT_PORTABLE_SPANSION_S25FL1XXK_INCLUDE_MA_SPANSION_S25FL1XXK_SFDP_H_
+#define FREERTOS_PLUS_FAT_PORTABLE_SPANSION_S25FL1XXK_INCLUDE_MA_SPANSION_S25FL1XXK_SFDP_H_
+
+#include <stdint.h>
+#include "FreeRTOS.h"
+#include "ma_spansion_s25fl1xxk_driver_config.h"
+#include "ma_spansion_s25fl1xxk_transport.h"
+
+/* SFDP header ("SFDP", revision, number of parameter headers - 1) and parameter headers. */
+#define spansionSFDP_SIGNATURE			0x50444653UL
+#define spansionSFDP_HEADER_SIZE		8
+#define spansionSFDP_MAX_HEADERS		8
+#define spansionSFDP_BASIC_ID			0xff00		/* JEDEC basic flash parameter table. */
+#define spansionSFDP_4BAIT_ID			0xff84		/* JEDEC 4-byte address instruction table. */
+#define spansionSFDP_BASIC_WORDS		16			/* Words of the basic table used (JESD216A). */
+#define spansionSFDP_4BAIT_WORDS		2
+
+/* Manufacturer ID of Spansion / Cypress (first byte of the JEDEC ID). */
+#define spansionJEDEC_SPANSION			0x01
+
+/* 3-byte addresses reach 16 MB. */
+#define spansionSPI_3BYTE_ADDRESS_LIMIT	0x01000000UL
+
+/* How the quad IO lines are enabled (SFDP quad enable requirements). */
+#define spansionSPI_QE_NONE				0		/* Nothing to set. */
+#define spansionSPI_QE_SR2_BIT1			1		/* QE is bit 1 of status register 2 (S25FL1xxK, S25FL-S CR1). */
+#define spansionSPI_QE_SR1_BIT6			2		/* QE is bit 6 of status register 1. */
+
+/* Geometry and command set of the chip of a disk. */
+typedef struct {
+	uint32_t			JedecId;			/* Manufacturer, memory type, capacity (0: not read). */
+	uint32_t			ChipSize;			/* Size of the chip [byte]. */
+	uint32_t			Size;				/* Size used by the driver [byte] (spansionSPI_SECTOR_COUNT at most). */
+	uint16_t			PageSize;			/* Page program buffer [byte]. */
+	uint16_t			SfdpRevision;		/* Major, minor revision of the SFDP (0: no SFDP). */
+	uint8_t				AddressBytes;		/* 3 or 4. */
+	uint8_t				ProgramOpcode;
+	uint8_t				SectorEraseOpcode;	/* 4 kB erase. */
+	uint8_t				BlockEraseOpcode;	/* 64 kB erase (0: the block is erased by sector erases). */
+	uint8_t				QuadEnable;			/* spansionSPI_QE_xxx. */
+	BaseType_t			Suspend;			/* Erase / program suspend (0x75 / 0x7A, SR2 SUS bit). */
+	spansion_transfer_t	Read;				/* Array read, the address and the data phase are set per read. */
+} spansion_geometry_t;
+
+/* Read commands of the chip, fastest last (prvSpansionSPI_SelectRead()). */
+#define spansionSFDP_READ_FAST			0		/* 1-1-1 */
+#define spansionSFDP_READ_QUAD_OUTPUT	1		/* 1-1-4 */
+#define spansionSFDP_READ_QUAD_IO		2		/* 1-4-4 */
+#define spansionSFDP_READ_COUNT			3
+
+/* Read command of the chip (Opcode 0: not supported). */
+typedef struct {
+	uint8_t				Opcode;
+	uint8_t				ModeClocks;			/* Mode bits [clock]. */
+	uint8_t				WaitClocks;			/* Wait states [clock]. */
+} spansion_read_command_t;
+
+static BaseType_t prvSpansionSPI_Probe(spansion_context_t *pxContext);
+
+#endif /* FREERTOS_PLUS_FAT_PORTABLE_SPANSION_S25FL1XXK_INCLUDE_MA_SPANSION_S25FL1XXK_SFDP_H_ */
@@ -0,0 +1,62 @@
+/**
+ * @file ma_spansion_s25fl1xxk_simulator.h
+ *
+ * @brief Host side S25FL1xxK flash simulator API.
+ * @author Lovas Szilárd <lovas.szilard@gmail.com>
+ * @version: 0.3
+ * @date: 2017-06-12 10:00
+ * - initial version
+ * @date: 2017-06-20 10:00
+ * - 0.2 ulSuspendViolations
+ * @date: 2017-07-10 10:00
+ * - 0.3 Several chips (spansionSPI_DEVICE_COUNT), the functions get the chip index.
+ */
+
+#ifndef FREERTOS_PLUS_FAT_PORTABLE_SPANSION_S25FL1XXK_INCLUDE_MA_SPANSION_S25FL1XXK_SIMULATOR_H_
+#define FREERTOS_PLUS_FAT_PORTABLE_SPANSION_S25FL1XXK_INCLUDE_MA_SPANSION_S25FL1XXK_SIMULATOR_H_
+
+#include <stdint.h>
+#include "FreeRTOS.h"
+#include "ma_spansion_s25fl1xxk_driver_config.h"
+
+/* Emulated device geometry. */
+#define spansionSIM_ARRAY_SIZE			(spansionSPI_SECTOR_COUNT * spansionFAT_SECTOR_SIZE)
+#define spansionSIM_BLOCK_SIZE			(65536)
+
+/* Default SPI clock of the emulated bus [Hz]. */
+#define spansionSIM_SPI_CLOCK_HZ		(5000000)
+
+/* Typical embedded operation times [us] (S25FL1xxK datasheet). */
+#define spansionSIM_tPP_US				(700)		/* Page program. */
+#define spansionSIM_tSE_US				(50000)		/* Sector (4 kB) erase. */
+#define spansionSIM_tBE_US				(500000)	/* Block (64 kB) erase. */
+#define spansionSIM_tCE_US				(40000000)	/* Chip erase. */
+#define spansionSIM_tW_US				(5000)		/* Non-volatile status register write. */
+#define spansionSIM_tSUS_US				(20)		/* Erase/program suspend latency. */
+
+typedef struct {
+	uint64_t		ullSpiClocks;			/* SPI clock cycles on the bus. */
+	uint64_t		ullBusyTime;			/* Time spent in embedded operations [us]. */
+	uint32_t		ulCommands;				/* Number of _CS cycles. */
+	uint32_t		ulStatusReads;			/* Status register reads (busy polling). */
+	uint32_t		ulReadBytes;			/* Bytes read from the array. */
+	uint32_t		ulPagePrograms;			/* Page program operations. */
+	uint32_t		ulProgramBytes;			/* Bytes shifted in by page programs. */
+	uint32_t		ulSectorErases;			/* 4 kB sector erases. */
+	uint32_t		ulBlockErases;			/* 64 kB block erases. */
+	uint32_t		ulChipErases;			/* Chip erases. */
+	uint32_t		ulSuspends;				/* Accepted erase/program suspends. */
+	uint32_t		ulNorViolations;		/* Bytes programmed with 0 -> 1 bit transitions. */
+	uint32_t		ulBusyViolations;		/* Commands ignored because the device was busy. */
+	uint32_t		ulSuspendViolations;	/* Bytes read from the area of a suspended program / erase. */
+	uint32_t		ulUnsupportedCommands;	/* Opcodes the simulator does not model. */
+} spansion_sim_stats_t;
+
+BaseType_t xSpansionSim_Open(UBaseType_t uxDevice, const char *pcFileName);
+void vSpansionSim_Close(UBaseType_t uxDevice);
+void vSpansionSim_SetSpiClock(uint32_t ulHz);
+void vSpansionSim_GetStats(UBaseType_t uxDevice, spansion_sim_stats_t *pxStats);
+void vSpansionSim_ResetStats(UBaseType_t uxDevice);
+uint64_t xGetHighResolutionTime(void);
+
+#endif /* FREERTOS_PLUS_FAT_PORTABLE_SPANSION_S25FL1XXK_INCLUDE_MA_SPANSION_S25FL1XXK_SIMULATOR_H_ */
@@ -0,0 +1,57 @@
+/**
+ * @file ma_spansion_s25fl1xxk_trace.h
+ *
+ * @brief Binary trace ring of the Spansion S25FL1xxk FreeRTOS+FAT driver.
+ * Every disk has a ring of fixed size events (FF_Disk_t.pvTag). The producer is
+ * the holder of the disk mutex (FFRead / FFWrite), the consumer is the task calling
+ * uxSpansionSPI_TraceDrain(), so neither side takes a lock and nothing is formatted
+ * on the read / write path. tools/ma_spansion_s25fl1xxk_trace_decode.c prints the
+ * drained events in the CSV format of the former vLoggingPrintf() trace macros.
+ * @author Lovas Szilárd <lovas.szilard@gmail.com>
+ * @version: 0.2
+ * @date: 2017-07-31 10:00
+ * - initial version
+ * @date: 2017-08-21 10:00
+ * - 0.2 Discard events.
+ */
+
+#ifndef FREERTOS_PLUS_FAT_PORTABLE_SPANSION_S25FL1XXK_INCLUDE_MA_SPANSION_S25FL1XXK_TRACE_H_
+#define FREERTOS_PLUS_FAT_PORTABLE_SPANSION_S25FL1XXK_INCLUDE_MA_SPANSION_S25FL1XXK_TRACE_H_
+
+#include <stdint.h>
+#include "FreeRTOS.h"
+#include "ma_spansion_s25fl1xxk_driver_config.h"
+
+/* Event operations. */
+#define spansionTRACE_OP_READ		'R'		/* FFRead request. */
+#define spansionTRACE_OP_WRITE		'W'		/* FFWrite request. */
+#define spansionTRACE_OP_DISCARD	'T'		/* xSpansionSPI_Discard() request (trim). */
+#define spansionTRACE_OP_LOST		'L'		/* The ring was full, Sector: number of lost events. */
+
+/* Event areas. */
+#define spansionTRACE_AREA_FAT		'F'
+#define spansionTRACE_AREA_DATA		'D'
+
+/* One event, 12 bytes without padding (stream format of the decoder, native byte order). */
+typedef struct {
+	uint32_t	Time;			/* Low 32 bits of xGetHighResolutionTime() [us]. */
+	uint32_t	Sector;			/* First FAT sector of the request. */
+	uint16_t	Count;			/* Number of FAT sectors (saturated at 0xffff). */
+	uint8_t		Op;				/* spansionTRACE_OP_xxx. */
+	uint8_t		Area;			/* spansionTRACE_AREA_xxx. */
+} spansion_trace_event_t;
+
+#if(spansionTRACE_RING_SIZE > 0)
+/* Single producer, single consumer ring: Head and Tail run free, Head - Tail events are stored. */
+typedef struct {
+	volatile spansion_trace_event_t	Events[spansionTRACE_RING_SIZE];
+	volatile uint32_t				Head;		/* Written by the producer only. */
+	volatile uint32_t				Tail;		/* Written by the consumer only. */
+	uint32_t						Lost;		/* Events lost since the last spansionTRACE_OP_LOST event (producer). */
+} spansion_trace_ring_t;
+
+static void prvSpansionSPI_TraceEvent(spansion_trace_ring_t *pxRing, uint8_t ucOp, uint8_t ucArea, uint32_t ulSector, uint32_t ulCount);
+static UBaseType_t prvSpansionSPI_TraceDrain(spansion_trace_ring_t *pxRing, spansion_trace_event_t *pxEvents, UBaseType_t uxMaxEvents);
+#endif
+
+#endif /* FREERTOS_PLUS_FAT_PORTABLE_SPANSION_S25FL1XXK_INCLUDE_MA_SPANSION_S25FL1XXK_TRACE_H_ */
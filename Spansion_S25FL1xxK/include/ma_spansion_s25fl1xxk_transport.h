@@ -0,0 +1,77 @@
+/**
+ * @file ma_spansion_s25fl1xxk_transport.h
+ *
+ * @brief SPI transport interface of the Spansion S25FL1xxk FreeRTOS+FAT driver.
+ * The command layer (ma_spansion_s25fl1xxk_transfer.inc) describes every flash
+ * command as one transfer (command, address, dummy and data phases in a single
+ * _CS cycle), the backends (portable/) shift it out.
+ * @author Lovas Szilárd <lovas.szilard@gmail.com>
+ * @version: 0.3
+ * @date: 2017-06-26 10:00
+ * - initial version
+ * @date: 2017-07-03 10:00
+ * - 0.2 Quad width address / mode / dummy phases, commands without opcode (continuous read mode).
+ * @date: 2017-10-02 10:00
+ * - 0.3 4 byte addresses.
+ */
+
+#ifndef FREERTOS_PLUS_FAT_PORTABLE_SPANSION_S25FL1XXK_INCLUDE_MA_SPANSION_S25FL1XXK_TRANSPORT_H_
+#define FREERTOS_PLUS_FAT_PORTABLE_SPANSION_S25FL1XXK_INCLUDE_MA_SPANSION_S25FL1XXK_TRANSPORT_H_
+
+#include <stdint.h>
+#include "FreeRTOS.h"
+
+/* Data phase width. */
+#define spansionSPI_WIDTH_SINGLE	1		/* SIMO / SOMI. */
+#define spansionSPI_WIDTH_QUAD		4		/* IO0..IO3. */
+
+/* Data phase direction. */
+#define spansionSPI_DIR_NONE		0
+#define spansionSPI_DIR_READ		1
+#define spansionSPI_DIR_WRITE		2
+
+/* Transport capabilities. */
+#define spansionSPI_CAP_QUAD		0x01	/* Quad width data phase is supported. */
+#define spansionSPI_CAP_ASYNC		0x02	/* fnTransferStart() returns before the data phase ends. */
+#define spansionSPI_CAP_QUAD_IO		0x04	/* Quad width address phase (Fast Read Quad I/O, 0xEB). */
+
+/* Transfer flags. */
+#define spansionSPI_FLAG_NO_OPCODE	0x01	/* Continuous read mode: the command starts with the address. */
+#define spansionSPI_FLAG_MODE		0x02	/* A mode byte (Mode) follows the address. */
+
+/* One flash command: _CS is active for the command, address, dummy and data phases. */
+typedef struct {
+	uint8_t		Opcode;
+	uint8_t		AddressBytes;		/* 0, 3 or 4. */
+	uint8_t		DummyBytes;			/* Dummy bytes after the address (8 / AddressWidth clocks each). */
+	uint8_t		AddressWidth;		/* Width of the address, mode and dummy phases. */
+	uint8_t		Width;				/* Data phase width (spansionSPI_WIDTH_xxx). */
+	uint8_t		Direction;			/* Data phase direction (spansionSPI_DIR_xxx). */
+	uint8_t		Flags;				/* spansionSPI_FLAG_xxx. */
+	uint8_t		Mode;				/* Mode byte (spansionSPI_FLAG_MODE). */
+	uint32_t	Address;
+	uint8_t		*Data;
+	uint32_t	Length;				/* Data phase length [byte]. */
+} spansion_transfer_t;
+
+/* Transport backend. */
+typedef struct xSPANSION_TRANSPORT {
+	const char	*pcName;
+	uint32_t	ulCapabilities;
+	void		*pvContext;			/* Passed to the functions below. */
+
+	/* Optional, called by the low level init before the first transfer. */
+	void		(*fnInit)(void *pvContext);
+
+	/* Blocking transfer. */
+	BaseType_t	(*fnTransfer)(void *pvContext, const spansion_transfer_t *pxTransfer);
+
+	/* Asynchronous transfer: fnTransferStart() starts it, fnTransferWait() waits for the end
+	 * and releases the bus, also when it times out (the transfer is aborted then).
+	 * The transfer descriptor and its buffer must be valid until then.
+	 * Backends without spansionSPI_CAP_ASYNC complete the transfer in fnTransferStart(). */
+	BaseType_t	(*fnTransferStart)(void *pvContext, const spansion_transfer_t *pxTransfer);
+	BaseType_t	(*fnTransferWait)(void *pvContext, TickType_t xTicksToWait);
+} spansion_transport_t;
+
+#endif /* FREERTOS_PLUS_FAT_PORTABLE_SPANSION_S25FL1XXK_INCLUDE_MA_SPANSION_S25FL1XXK_TRANSPORT_H_ */
@@ -1,259 +1,887 @@
-/**
- * @file ma_spansion_s25fl1xxk.c
- *
- * @brief FreeRTOS+FAT driver for Spansion S25FL1xxk SPI flash devices.
- * @author Lovas Szilrd <lovas.szilard@gmail.com>
- * @version: 0.3
- * @date: 2017-03-26 8:00
- * - initial version
- * @Date: 2017-03-27 8:00
- * - 0.2
- * + Code reorganization
- * @date: 2017-05-03 8:00
- * - 0.3
- * + function BaseType_t xSpansionSPI_IsChipEraseInProgress(void) added.
- */
-
-#include "ma_spansion_s25fl1xxk.h"
-
-/* Put the (cache) logic and the low level parts into single compilation unit. */
-#include "ma_spansion_s25fl1xxk_cache.inc"
-#include "portable/ma_hercules_bit_banging.inc"
-#include "ma_spansion_s25fl1xxk_transfer.inc"
-
-static FF_Error_t prvPartitionAndFormatDisk(FF_Disk_t *pxDisk);
-static FF_Error_t FF_SPIDiskDestroy(char *pcName);
-static void prvSpansionSPI_LowLevelInit(void);
-
-/**
- * @fn FF_Disk_t *FF_SPIDiskInit(char *pcName, uint8_t ucNeedFormat)
- * @brief Initializes and mount the SPI disk
- * @param pcName path
- * @param ucNeedFormat (pdTRUE if disk format is needed)
- * @return pointer to the FF_Disk_t structure
- */
-FF_Disk_t *FF_SPIDiskInit(char *pcName, uint8_t ucNeedFormat)
-{
-	FF_Error_t xError;
-	FF_Disk_t *pxDisk = NULL;
-	FF_CreationParameters_t xParameters;
-
-	prvSpansionSPI_LowLevelInit();
-
-	/* Attempt to allocated the FF_Disk_t structure. */
-    pxDisk = ( FF_Disk_t * ) pvPortMalloc( sizeof( FF_Disk_t ) );
-
-    if( pxDisk != NULL )
-    {
-        /* It is advisable to clear the entire structure to zero after it has been
-        allocated - that way the media driver will be compatible with future
-        FreeRTOS+FAT versions, in which the FF_Disk_t structure may include
-        additional members. */
-        memset( pxDisk, '\0', sizeof( FF_Disk_t ) );
-
-        /* The pvTag member of the FF_Disk_t structure allows the structure to be
-        extended to also include media specific parameters. */
-        pxDisk->pvTag = ( void * )NULL;
-
-        /* The signature is used by the disk read and disk write functions to
-        ensure the disk being accessed is an SPI disk. */
-        pxDisk->ulSignature = spansionSPI_SIGNATURE;
-
-        /* The number of sectors is recorded for bounds checking in the read and
-        write functions. */
-        pxDisk->ulNumberOfSectors = spansionSPI_SECTOR_COUNT;
-
-        /* Create the IO manager that will be used to control the SPI disk -
-        the FF_CreationParameters_t structure completed with the required
-        parameters, then passed into the FF_CreateIOManager() function. */
-        memset (&xParameters, '\0', sizeof xParameters);
-        xParameters.pucCacheMemory = NULL;
-        xParameters.ulMemorySize = spansionSPI_IOMANAGER_CACHE_SIZE;
-        xParameters.ulSectorSize = spansionFAT_SECTOR_SIZE;
-        xParameters.fnWriteBlocks = prvSpansionSPI_FFWrite;
-        xParameters.fnReadBlocks = prvSpansionSPI_FFRead;
-        xParameters.pxDisk = pxDisk;
-
-        /* The Spansion SPI driver is not re-entrant */
-        xParameters.pvSemaphore = ( void * ) xSemaphoreCreateRecursiveMutex();
-        xParameters.xBlockDeviceIsReentrant = pdFALSE;
-
-        pxDisk->pxIOManager = FF_CreateIOManger( &xParameters, &xError );
-
-        if( ( pxDisk->pxIOManager != NULL ) && ( FF_isERR( xError ) == pdFALSE ) )
-        {
-            /* Record that the SPI disk has been initialised. */
-            pxDisk->xStatus.bIsInitialised = pdTRUE;
-
-            if(ucNeedFormat)
-            {
-            	xError = prvPartitionAndFormatDisk(pxDisk);
-            }
-
-            if( FF_isERR( xError ) == pdFALSE )
-            {
-                /* Record the partition number the FF_Disk_t structure is, then
-                mount the partition. */
-                pxDisk->xStatus.bPartitionNumber = spansionSPI_PARTITION_NUMBER;
-
-                /* Mount the partition. */
-                xError = FF_Mount( pxDisk, spansionSPI_PARTITION_NUMBER );
-            }
-
-            if( FF_isERR( xError ) == pdFALSE )
-            {
-                /* The partition mounted successfully, add it to the virtual
-                file system - where it will appear as a directory off the file
-                system's root directory. */
-                FF_FS_Add( pcName, pxDisk );
-            }
-        }
-        else
-        {
-            /* The disk structure was allocated, but the disk's IO manager could
-            not be allocated, so free the disk again. */
-    		pxDisk->ulSignature = 0;
-    		pxDisk->xStatus.bIsInitialised = 0;
-    		if( pxDisk->pxIOManager != NULL )
-    		{
-    			FF_DeleteIOManager( pxDisk->pxIOManager );
-    		}
-    		vPortFree( pxDisk );
-        }
-    }
-
-    return pxDisk;
-}
-
-/**
- * @fn static BaseType_t FF_SPIDiskDestroy(char *pcName)
- * @brief unmount and delete disk on pcName path
- * @param pcName path
- * @return FF_Error_t error code
- */
-static FF_Error_t FF_SPIDiskDestroy(char *pcName)
-{
-	FF_Error_t xError;
-	FF_Disk_t *pxDisk = NULL;
-	FF_SubSystem_t xSubsystemEntry;
-	int xNameLen = (int) strlen(pcName), i;
-
-	/* Search for disk named pcName */
-	for(i=0; i<FF_FS_Count(); i++)
-	{
-		FF_FS_Get(i, &xSubsystemEntry);
-		if((xSubsystemEntry.xPathlen == xNameLen) && (memcmp( xSubsystemEntry.pcPath, pcName, (size_t)xNameLen) == 0))
-		{
-			pxDisk = xSubsystemEntry.pxManager->xBlkDevice.pxDisk;
-			break;
-		}
-	}
-
-	/* Unmount the disk. */
-	if(pxDisk != NULL)
-	{
-		xError = FF_Unmount(pxDisk);
-	}
-	else
-	{
-		xError = FF_ERR_NULL_POINTER;
-	}
-
-	/* Delete the IOManager. */
-	if(xError == FF_ERR_NONE)
-	{
-		if(pxDisk->pxIOManager != NULL)
-		{
-			FF_DeleteIOManager(pxDisk->pxIOManager);
-		}
-		vPortFree( pxDisk );
-	}
-    return xError;
-}
-
-/**
- * @fn static FF_Error_t prvPartitionAndFormatDisk( FF_Disk_t *pxDisk )
- * @brief formats and creates partition on disk pxDisk
- * @param pxDisk
- * @return FF_Error_t error code
- */
-static FF_Error_t prvPartitionAndFormatDisk( FF_Disk_t *pxDisk )
-{
-	FF_PartitionParameters_t xPartition;
-	FF_Error_t xError;
-
-	/* Create a single partition that fills all available space on the disk. */
-	memset( &xPartition, '\0', sizeof( xPartition ) );
-	xPartition.ulSectorCount = pxDisk->ulNumberOfSectors;
-	xPartition.ulHiddenSectors = spansionSPI_HIDDEN_SECTOR_COUNT;
-	xPartition.xPrimaryCount = spansionSPI_PRIMARY_PARTITIONS;
-	xPartition.eSizeType = eSizeIsQuota;
-
-	/* Partition the disk */
-	xError = FF_Partition( pxDisk, &xPartition );
-	FF_PRINTF( "FF_Partition: %s\n", ( const char * ) FF_GetErrMessage( xError ) );
-
-	if( FF_isERR( xError ) == pdFALSE )
-	{
-		/* Format the partition. */
-		xError = FF_Format( pxDisk, spansionSPI_PARTITION_NUMBER, pdTRUE, pdTRUE );
-		FF_PRINTF( "FF_SPIDiskInit: FF_Format: %s\n", ( const char * ) FF_GetErrMessage( xError ) );
-	}
-
-	return xError;
-}
-
-void vSpansionSPI_PartitionAndFormatDisk(char *pcName)
-{
-#if(0)
-	if(FF_SPIDiskDestroy(pcName) != (FF_ERR_IOMAN_ACTIVE_HANDLES | FF_UNMOUNT))
-	{
-		FF_SPIDiskInit(pcName, pdTRUE);
-	}
-#else
-	FF_SPIDiskDestroy(pcName);
-	FF_SPIDiskInit(pcName, pdTRUE);
-#endif
-}
-
-BaseType_t xSpansionSPI_SyncCache(FF_Disk_t *pxDisk, cache_stamp_t xOlderThan)
-{
-	BaseType_t xReturn = pdFALSE;
-
-	if(pxDisk != NULL && pxDisk->pxIOManager->pvSemaphore != NULL)
-	{
-		xReturn = xSemaphoreTakeRecursive((SemaphoreHandle_t)pxDisk->pxIOManager->pvSemaphore, 1);
-		if(pdTRUE == xReturn)
-		{
-			prvSpansionSPI_SyncCache(xSpiCache, cacheSPI_CACHE_SIZE, xOlderThan);
-			xSemaphoreGiveRecursive((SemaphoreHandle_t)pxDisk->pxIOManager->pvSemaphore);
-		}
-	}
-	return(xReturn);
-}
-
-/**
- * @fn BaseType_t xSpansionSPI_IsChipEraseInProgress(void)
- * @brief Check if the chip erase is being in progress.
- * @return pdTRUE in case of device is busy
- */
-inline BaseType_t xSpansionSPI_IsChipEraseInProgress(void)
-{
-	return(prvSpansionSPI_IsChipEraseInProgress());
-}
-
-/**
- * @fn void vSpansionSPI_ChipErase(void)
- * @brief Public wrapper for prvSpansionSPI_ChipErase() function.
- */
-void vSpansionSPI_ChipErase(void)
-{
-	prvSpansionSPI_ChipErase();
-}
-
-static void prvSpansionSPI_LowLevelInit(void)
-{
-
-	prvSpansionSPI_InitCache(xSpiCache, cacheSPI_CACHE_SIZE);
-	prvSpansionSPI_QuadEnable();
-}
+/**
+ * @file ma_spansion_s25fl1xxk.c
+ *
+ * @brief FreeRTOS+FAT driver for Spansion S25FL1xxk SPI flash devices.
+ * @author Lovas Szilárd <lovas.szilard@gmail.com>
+ * @version: 0.14
+ * @date: 2017-03-26 8:00
+ * - initial version
+ * @Date: 2017-03-27 8:00
+ * - 0.2
+ * + Code reorganization
+ * @date: 2017-05-03 8:00
+ * - 0.3
+ * + function BaseType_t xSpansionSPI_IsChipEraseInProgress(void) added.
+ * @date: 2017-06-12 10:00
+ * - 0.4
+ * + Portable layer selection (spansionSPI_PORT), host simulator port added.
+ * @date: 2017-06-26 10:00
+ * - 0.5
+ * + Transport interface, MibSPI / DMA port, xSpansionSPI_SetTransport().
+ * @date: 2017-07-10 10:00
+ * - 0.6
+ * + Per disk context (FF_Disk_t.pvTag): several chips can be mounted, FF_SPIDiskInitEx(),
+ *   pxSpansionSPI_GetTransport(). xSpansionSPI_SetTransport() is replaced by the disk configuration.
+ * @date: 2017-07-24 10:00
+ * - 0.7
+ * + Statistics: vSpansionSPI_GetStats(), vSpansionSPI_ResetStats().
+ * @date: 2017-07-31 10:00
+ * - 0.8
+ * + Binary trace ring: uxSpansionSPI_TraceDrain().
+ * @date: 2017-08-14 10:00
+ * - 0.9
+ * + Flash translation layer: the log is mounted with the disk, reset by the chip erase.
+ * @date: 2017-08-21 10:00
+ * - 0.10
+ * + Discard: xSpansionSPI_Discard(), xSpansionSPI_DiscardFreeClusters().
+ * @date: 2017-08-28 10:00
+ * - 0.11
+ * + Read-ahead: the asynchronous sector read is completed before the context is freed.
+ * @date: 2017-09-11 10:00
+ * - 0.12
+ * + Unified buffering: the IOManager gets only a few buffers (spansionSPI_UNIFIED_CACHE).
+ * @date: 2017-09-18 10:00
+ * - 0.13
+ * + Fast format: the disk is erased before FF_Partition() / FF_Format() (cacheSPI_FAST_FORMAT_ENABLE).
+ *   vSpansionSPI_PartitionAndFormatDisk() keeps the known erased sectors of the old disk, the chip
+ *   erase drops the cache.
+ * @date: 2017-10-02 10:00
+ * - 0.14
+ * + Chip identification (JEDEC ID, SFDP) and 4-byte addresses: the default disk size follows the chip,
+ *   the init fails if the chip is not supported or the disk doesn't fit, vSpansionSPI_GetGeometry().
+ */
+
+#include "ma_spansion_s25fl1xxk.h"
+
+/* Put the (cache) logic and the low level parts into single compilation unit. */
+#include "ma_spansion_s25fl1xxk_cache.inc"
+#if(spansionSPI_PORT == spansionSPI_PORT_HOST_SIMULATOR)
+#include "portable/ma_host_flash_simulator.inc"
+#elif(spansionSPI_PORT == spansionSPI_PORT_HERCULES_MIBSPI_DMA)
+#include "portable/ma_hercules_mibspi_dma.inc"
+#else
+#include "portable/ma_hercules_bit_banging.inc"
+#endif
+#include "ma_spansion_s25fl1xxk_transfer.inc"
+#include "ma_spansion_s25fl1xxk_sfdp.inc"
+#include "ma_spansion_s25fl1xxk_ftl.inc"
+#include "ma_spansion_s25fl1xxk_trace.inc"
+
+static FF_Error_t prvPartitionAndFormatDisk(FF_Disk_t *pxDisk);
+static FF_Error_t FF_SPIDiskDestroy(char *pcName, uint32_t *pulErased);
+static FF_Disk_t *prvSpansionSPI_DiskInit(char *pcName, uint8_t ucNeedFormat, const spansion_disk_config_t *pxConfig, const uint32_t *pulErased);
+#if(cacheSPI_FAST_FORMAT_ENABLE)
+static void prvSpansionSPI_EraseDisk(spansion_context_t *pxContext);
+#endif
+static spansion_context_t *prvSpansionSPI_CreateContext(const spansion_disk_config_t *pxConfig);
+static void prvSpansionSPI_FlushContext(spansion_context_t *pxContext);
+static void prvSpansionSPI_DeleteContext(spansion_context_t *pxContext);
+static BaseType_t prvSpansionSPI_LowLevelInit(spansion_context_t *pxContext);
+
+/* Transports of the chips of the port (pxSpansionSPI_GetTransport()). */
+static spansion_transport_t xSpiTransports[spansionSPI_DEVICE_COUNT];
+
+/**
+ * @fn FF_Disk_t *FF_SPIDiskInit(char *pcName, uint8_t ucNeedFormat)
+ * @brief Initializes and mount the SPI disk on the first chip of the port
+ * @param pcName path
+ * @param ucNeedFormat (pdTRUE if disk format is needed)
+ * @return pointer to the FF_Disk_t structure
+ */
+FF_Disk_t *FF_SPIDiskInit(char *pcName, uint8_t ucNeedFormat)
+{
+	return(FF_SPIDiskInitEx(pcName, ucNeedFormat, NULL));
+}
+
+/**
+ * @fn FF_Disk_t *FF_SPIDiskInitEx(char *pcName, uint8_t ucNeedFormat, const spansion_disk_config_t *pxConfig)
+ * @brief Initializes and mount an SPI disk. Every disk has its own context (cache, mutex,
+ * write back task), so the disks of different chips are accessed independently.
+ * @param pcName path
+ * @param ucNeedFormat (pdTRUE if disk format is needed)
+ * @param pxConfig transport of the chip and size of the disk (NULL: first chip, default size)
+ * @return pointer to the FF_Disk_t structure
+ */
+FF_Disk_t *FF_SPIDiskInitEx(char *pcName, uint8_t ucNeedFormat, const spansion_disk_config_t *pxConfig)
+{
+	return(prvSpansionSPI_DiskInit(pcName, ucNeedFormat, pxConfig, NULL));
+}
+
+/**
+ * @fn static FF_Disk_t *prvSpansionSPI_DiskInit(char *pcName, uint8_t ucNeedFormat, const spansion_disk_config_t *pxConfig, const uint32_t *pulErased)
+ * @brief FF_SPIDiskInitEx() with the known erased sectors of the chip.
+ * @param pcName path
+ * @param ucNeedFormat (pdTRUE if disk format is needed)
+ * @param pxConfig transport of the chip and size of the disk (NULL: first chip, default size)
+ * @param pulErased bitmap of the erased sectors of a previous disk on the chip (NULL: unknown)
+ * @return pointer to the FF_Disk_t structure
+ */
+static FF_Disk_t *prvSpansionSPI_DiskInit(char *pcName, uint8_t ucNeedFormat, const spansion_disk_config_t *pxConfig, const uint32_t *pulErased)
+{
+	FF_Error_t xError;
+	FF_Disk_t *pxDisk = NULL;
+	FF_CreationParameters_t xParameters;
+	spansion_context_t *pxContext;
+
+	pxContext = prvSpansionSPI_CreateContext(pxConfig);
+	if(pxContext == NULL)
+	{
+		return(NULL);
+	}
+
+	if(prvSpansionSPI_LowLevelInit(pxContext) == pdFAIL)
+	{
+		FF_PRINTF("FF_SPIDiskInit: chip %06lx not supported or smaller than the disk\n", (unsigned long)pxContext->xGeometry.JedecId);
+		prvSpansionSPI_DeleteContext(pxContext);
+		return(NULL);
+	}
+#if(cacheSPI_DISCARD_ENABLE)
+	if(pulErased != NULL)
+	{
+		memcpy(pxContext->xDiscard.Erased, pulErased, sizeof(pxContext->xDiscard.Erased));
+	}
+#else
+	( void ) pulErased;
+#endif
+
+	/* Attempt to allocated the FF_Disk_t structure. */
+    pxDisk = ( FF_Disk_t * ) pvPortMalloc( sizeof( FF_Disk_t ) );
+
+    if( pxDisk == NULL )
+    {
+		prvSpansionSPI_DeleteContext(pxContext);
+    }
+    else
+    {
+        /* It is advisable to clear the entire structure to zero after it has been
+        allocated - that way the media driver will be compatible with future
+        FreeRTOS+FAT versions, in which the FF_Disk_t structure may include
+        additional members. */
+        memset( pxDisk, '\0', sizeof( FF_Disk_t ) );
+
+        /* The pvTag member of the FF_Disk_t structure allows the structure to be
+        extended to also include media specific parameters. */
+        pxDisk->pvTag = ( void * )pxContext;
+
+        /* The signature is used by the disk read and disk write functions to
+        ensure the disk being accessed is an SPI disk. */
+        pxDisk->ulSignature = spansionSPI_SIGNATURE;
+
+        /* The number of sectors is recorded for bounds checking in the read and
+        write functions. */
+        pxDisk->ulNumberOfSectors = pxContext->xConfig.ulSectorCount;
+
+        /* Create the IO manager that will be used to control the SPI disk -
+        the FF_CreationParameters_t structure completed with the required
+        parameters, then passed into the FF_CreateIOManager() function. With
+        spansionSPI_UNIFIED_CACHE the sectors are buffered by the driver cache. */
+        memset (&xParameters, '\0', sizeof xParameters);
+        xParameters.pucCacheMemory = NULL;
+        xParameters.ulMemorySize = spansionSPI_IOMANAGER_CACHE_SIZE;
+        xParameters.ulSectorSize = spansionFAT_SECTOR_SIZE;
+        xParameters.fnWriteBlocks = prvSpansionSPI_FFWrite;
+        xParameters.fnReadBlocks = prvSpansionSPI_FFRead;
+        xParameters.pxDisk = pxDisk;
+
+        /* The Spansion SPI driver is not re-entrant */
+        xParameters.pvSemaphore = ( void * ) xSemaphoreCreateRecursiveMutex();
+        xParameters.xBlockDeviceIsReentrant = pdFALSE;
+
+        pxDisk->pxIOManager = FF_CreateIOManger( &xParameters, &xError );
+
+        if( ( pxDisk->pxIOManager != NULL ) && ( FF_isERR( xError ) == pdFALSE ) )
+        {
+            /* Record that the SPI disk has been initialised. */
+            pxDisk->xStatus.bIsInitialised = pdTRUE;
+
+            if(ucNeedFormat)
+            {
+            	xError = prvPartitionAndFormatDisk(pxDisk);
+            }
+
+            if( FF_isERR( xError ) == pdFALSE )
+            {
+                /* Record the partition number the FF_Disk_t structure is, then
+                mount the partition. */
+                pxDisk->xStatus.bPartitionNumber = spansionSPI_PARTITION_NUMBER;
+
+                /* Mount the partition. */
+                xError = FF_Mount( pxDisk, spansionSPI_PARTITION_NUMBER );
+            }
+
+            if( FF_isERR( xError ) == pdFALSE )
+            {
+                /* The partition mounted successfully, add it to the virtual
+                file system - where it will appear as a directory off the file
+                system's root directory. */
+                FF_FS_Add( pcName, pxDisk );
+            }
+        }
+        else
+        {
+            /* The disk structure was allocated, but the disk's IO manager could
+            not be allocated, so free the disk again. */
+    		pxDisk->ulSignature = 0;
+    		pxDisk->xStatus.bIsInitialised = 0;
+    		if( pxDisk->pxIOManager != NULL )
+    		{
+    			FF_DeleteIOManager( pxDisk->pxIOManager );
+    		}
+    		prvSpansionSPI_DeleteContext(pxContext);
+    		vPortFree( pxDisk );
+    		pxDisk = NULL;
+        }
+    }
+
+    return pxDisk;
+}
+
+/**
+ * @fn static BaseType_t FF_SPIDiskDestroy(char *pcName, uint32_t *pulErased)
+ * @brief unmount and delete disk on pcName path
+ * @param pcName path
+ * @param pulErased NULL or destination of the bitmap of the erased sectors (cacheDISCARD_MAP_WORDS words)
+ * @return FF_Error_t error code
+ */
+static FF_Error_t FF_SPIDiskDestroy(char *pcName, uint32_t *pulErased)
+{
+	FF_Error_t xError;
+	FF_Disk_t *pxDisk = NULL;
+	FF_SubSystem_t xSubsystemEntry;
+	int xNameLen = (int) strlen(pcName), i;
+
+	/* Search for disk named pcName */
+	for(i=0; i<FF_FS_Count(); i++)
+	{
+		FF_FS_Get(i, &xSubsystemEntry);
+		if((xSubsystemEntry.xPathlen == xNameLen) && (memcmp( xSubsystemEntry.pcPath, pcName, (size_t)xNameLen) == 0))
+		{
+			pxDisk = xSubsystemEntry.pxManager->xBlkDevice.pxDisk;
+			break;
+		}
+	}
+
+	/* Unmount the disk. */
+	if(pxDisk != NULL)
+	{
+		xError = FF_Unmount(pxDisk);
+	}
+	else
+	{
+		xError = FF_ERR_NULL_POINTER;
+	}
+
+	/* Delete the IOManager. */
+	if(xError == FF_ERR_NONE)
+	{
+		if(pxDisk->pxIOManager != NULL)
+		{
+			FF_DeleteIOManager(pxDisk->pxIOManager);
+		}
+		/* The modified lines are written back before the erased sectors are reported. */
+		prvSpansionSPI_FlushContext((spansion_context_t *)pxDisk->pvTag);
+#if(cacheSPI_DISCARD_ENABLE)
+		if(pulErased != NULL)
+		{
+			memcpy(pulErased, ((spansion_context_t *)pxDisk->pvTag)->xDiscard.Erased, sizeof(((spansion_context_t *)pxDisk->pvTag)->xDiscard.Erased));
+		}
+#else
+		( void ) pulErased;
+#endif
+		prvSpansionSPI_DeleteContext((spansion_context_t *)pxDisk->pvTag);
+		vPortFree( pxDisk );
+	}
+    return xError;
+}
+
+/**
+ * @fn static spansion_context_t *prvSpansionSPI_CreateContext(const spansion_disk_config_t *pxConfig)
+ * @brief Allocates the context of a disk.
+ * @param pxConfig disk configuration (NULL: first chip of the port, default size).
+ * @return context or NULL.
+ */
+static spansion_context_t *prvSpansionSPI_CreateContext(const spansion_disk_config_t *pxConfig)
+{
+	spansion_context_t *pxContext;
+	const spansion_transport_t *pxTransport = (pxConfig != NULL) ? pxConfig->pxTransport : NULL;
+
+	if(pxTransport == NULL)
+	{
+		pxTransport = pxSpansionSPI_GetTransport(0);
+	}
+	if((pxTransport->fnTransfer == NULL) || (pxTransport->fnTransferStart == NULL) || (pxTransport->fnTransferWait == NULL))
+	{
+		return(NULL);
+	}
+
+	pxContext = (spansion_context_t *)pvPortMalloc(sizeof(spansion_context_t));
+	if(pxContext == NULL)
+	{
+		return(NULL);
+	}
+	memset(pxContext, '\0', sizeof(spansion_context_t));
+
+	pxContext->xConfig.pxTransport = pxTransport;
+	/* 0: the default size is set by the low level init from the size of the chip. */
+	pxContext->xConfig.ulSectorCount = (pxConfig != NULL) ? pxConfig->ulSectorCount : 0;
+	pxContext->xMutex = xSemaphoreCreateRecursiveMutex();
+	if(pxContext->xMutex == NULL)
+	{
+		vPortFree(pxContext);
+		return(NULL);
+	}
+	return(pxContext);
+}
+
+/**
+ * @fn static void prvSpansionSPI_FlushContext(spansion_context_t *pxContext)
+ * @brief Stops the write back task of the disk, writes back the cache and waits for the end of
+ * the pending erase / program: the next context of the chip starts without pending operation.
+ * @param pxContext disk context.
+ */
+static void prvSpansionSPI_FlushContext(spansion_context_t *pxContext)
+{
+	xSemaphoreTakeRecursive(pxContext->xMutex, portMAX_DELAY);
+	if(pxContext->xWriteback.Task != NULL)
+	{
+		vTaskDelete(pxContext->xWriteback.Task);
+		pxContext->xWriteback.Task = NULL;
+	}
+#if(cacheREAD_AHEAD_ASYNC)
+	prvSpansionSPI_SectorReadWait(pxContext);
+#endif
+	prvSpansionSPI_SyncCache(pxContext, 0);
+	/* A chip not identified by the low level init is not polled. */
+	if((pxContext->xPending.Operation != spansionSPI_OP_NONE) || (pxContext->xChipEraseInProgress != pdFALSE))
+	{
+		prvSpansionSPI_WaitReady(pxContext, pdTRUE);
+		pxContext->xPending.Operation = spansionSPI_OP_NONE;
+		pxContext->xChipEraseInProgress = pdFALSE;
+	}
+	xSemaphoreGiveRecursive(pxContext->xMutex);
+}
+
+/**
+ * @fn static void prvSpansionSPI_DeleteContext(spansion_context_t *pxContext)
+ * @brief Flushes (prvSpansionSPI_FlushContext()) and frees the context of a disk.
+ * @param pxContext disk context.
+ */
+static void prvSpansionSPI_DeleteContext(spansion_context_t *pxContext)
+{
+	prvSpansionSPI_FlushContext(pxContext);
+	vSemaphoreDelete(pxContext->xMutex);
+	vPortFree(pxContext);
+}
+
+/**
+ * @fn const spansion_transport_t *pxSpansionSPI_GetTransport(UBaseType_t uxDevice)
+ * @brief Transport of a chip of the port (spansionSPI_DEVICE_COUNT chips), for FF_SPIDiskInitEx().
+ * @param uxDevice chip index.
+ * @return transport or NULL.
+ */
+const spansion_transport_t *pxSpansionSPI_GetTransport(UBaseType_t uxDevice)
+{
+	if(uxDevice >= spansionSPI_DEVICE_COUNT)
+	{
+		return(NULL);
+	}
+	if(xSpiTransports[uxDevice].fnTransfer == NULL)
+	{
+		xSpiTransports[uxDevice] = spansionSPI_DEFAULT_TRANSPORT;
+		xSpiTransports[uxDevice].pvContext = spansionSPI_DEVICE_CONTEXT(uxDevice);
+	}
+	return(&xSpiTransports[uxDevice]);
+}
+
+/**
+ * @fn static FF_Error_t prvPartitionAndFormatDisk( FF_Disk_t *pxDisk )
+ * @brief formats and creates partition on disk pxDisk. With cacheSPI_FAST_FORMAT_ENABLE the disk
+ * is erased first, so the FAT and directory sectors are written into known erased lines.
+ * @param pxDisk
+ * @return FF_Error_t error code
+ */
+static FF_Error_t prvPartitionAndFormatDisk( FF_Disk_t *pxDisk )
+{
+	FF_PartitionParameters_t xPartition;
+	FF_Error_t xError;
+
+#if(cacheSPI_FAST_FORMAT_ENABLE)
+	spansion_context_t *pxContext = (spansion_context_t *)pxDisk->pvTag;
+
+	xSemaphoreTakeRecursive(pxContext->xMutex, portMAX_DELAY);
+	prvSpansionSPI_EraseDisk(pxContext);
+	xSemaphoreGiveRecursive(pxContext->xMutex);
+#endif
+
+	/* Create a single partition that fills all available space on the disk. */
+	memset( &xPartition, '\0', sizeof( xPartition ) );
+	xPartition.ulSectorCount = pxDisk->ulNumberOfSectors;
+	xPartition.ulHiddenSectors = spansionSPI_HIDDEN_SECTOR_COUNT;
+	xPartition.xPrimaryCount = spansionSPI_PRIMARY_PARTITIONS;
+	xPartition.eSizeType = eSizeIsQuota;
+
+	/* Partition the disk */
+	xError = FF_Partition( pxDisk, &xPartition );
+	FF_PRINTF( "FF_Partition: %s\n", ( const char * ) FF_GetErrMessage( xError ) );
+
+	if( FF_isERR( xError ) == pdFALSE )
+	{
+		/* Format the partition. */
+		xError = FF_Format( pxDisk, spansionSPI_PARTITION_NUMBER, pdTRUE, pdTRUE );
+		FF_PRINTF( "FF_SPIDiskInit: FF_Format: %s\n", ( const char * ) FF_GetErrMessage( xError ) );
+	}
+
+	return xError;
+}
+
+/**
+ * @fn void vSpansionSPI_PartitionAndFormatDisk(char *pcName)
+ * @brief Creates the disk on pcName path again on the same chip with a new partition and format.
+ * The sectors known erased by the old disk (e.g. vSpansionSPI_ChipErase()) stay known erased:
+ * the format writes into them without read and erase, the fast format doesn't erase them again.
+ * If the old disk can't be deleted (FF_SPIDiskDestroy()), it is kept and no disk is created.
+ * @param pcName path
+ */
+void vSpansionSPI_PartitionAndFormatDisk(char *pcName)
+{
+	spansion_disk_config_t xConfig = { NULL, 0 };
+	FF_SubSystem_t xSubsystemEntry;
+	FF_Error_t xError;
+	size_t xNameLen = strlen(pcName);
+	int i;
+	uint32_t *pulErased = NULL;
+
+	/* The disk is created again on the same chip. */
+	for(i=0; i<FF_FS_Count(); i++)
+	{
+		FF_FS_Get(i, &xSubsystemEntry);
+		if((xSubsystemEntry.xPathlen == xNameLen) && (memcmp( xSubsystemEntry.pcPath, pcName, xNameLen) == 0))
+		{
+			xConfig = ((spansion_context_t *)xSubsystemEntry.pxManager->xBlkDevice.pxDisk->pvTag)->xConfig;
+			break;
+		}
+	}
+#if(cacheSPI_DISCARD_ENABLE)
+	pulErased = (uint32_t *)pvPortMalloc(cacheDISCARD_MAP_WORDS * sizeof(uint32_t));
+#endif
+	xError = FF_SPIDiskDestroy(pcName, pulErased);
+	if(xError == FF_ERR_NONE)
+	{
+		if(prvSpansionSPI_DiskInit(pcName, pdTRUE, &xConfig, pulErased) == NULL)
+		{
+			FF_PRINTF("vSpansionSPI_PartitionAndFormatDisk: %s not created\n", pcName);
+		}
+	}
+	else
+	{
+		/* The old disk is kept (e.g. open handles or unknown path), its chip is not touched. */
+		FF_PRINTF("vSpansionSPI_PartitionAndFormatDisk: %s not deleted: %s\n", pcName, (const char *)FF_GetErrMessage(xError));
+	}
+	if(pulErased != NULL)
+	{
+		vPortFree(pulErased);
+	}
+}
+
+BaseType_t xSpansionSPI_SyncCache(FF_Disk_t *pxDisk, cache_stamp_t xOlderThan)
+{
+	spansion_context_t *pxContext;
+	BaseType_t xReturn = pdFALSE;
+
+	if(pxDisk != NULL && pxDisk->pvTag != NULL)
+	{
+		pxContext = (spansion_context_t *)pxDisk->pvTag;
+		xReturn = xSemaphoreTakeRecursive(pxContext->xMutex, 1);
+		if(pdTRUE == xReturn)
+		{
+			prvSpansionSPI_SyncCache(pxContext, xOlderThan);
+			xSemaphoreGiveRecursive(pxContext->xMutex);
+		}
+	}
+	return(xReturn);
+}
+
+/**
+ * @fn BaseType_t xSpansionSPI_Discard(FF_Disk_t *pxDisk, uint32_t ulSectorNumber, uint32_t ulSectorCount)
+ * @brief Tells the driver that a range of FAT sectors is no longer used (freed clusters, deleted file),
+ * their content is undefined until they are written again. The whole 4 kB sectors of the range are
+ * dropped from the cache without write back and erased by the write back task when it is idle,
+ * later writes into them need neither a read nor an erase.
+ * @param pxDisk SPI disk.
+ * @param ulSectorNumber first FAT sector.
+ * @param ulSectorCount number of FAT sectors.
+ * @return pdPASS on success, pdFAIL on a wrong range or during a chip erase.
+ */
+BaseType_t xSpansionSPI_Discard(FF_Disk_t *pxDisk, uint32_t ulSectorNumber, uint32_t ulSectorCount)
+{
+	spansion_context_t *pxContext;
+	uint32_t xFirst, xEnd;
+
+	if(pxDisk == NULL || pxDisk->pvTag == NULL || ulSectorNumber > pxDisk->ulNumberOfSectors || ulSectorCount > pxDisk->ulNumberOfSectors - ulSectorNumber)
+	{
+		return(pdFAIL);
+	}
+	pxContext = (spansion_context_t *)pxDisk->pvTag;
+
+	/* Partially covered lines hold sectors in use. */
+	xFirst = (ulSectorNumber * spansionFAT_SECTOR_SIZE + cacheLINE_SIZE - 1) & ~(uint32_t)(cacheLINE_SIZE - 1);
+	xEnd = ((ulSectorNumber + ulSectorCount) * spansionFAT_SECTOR_SIZE) & ~(uint32_t)(cacheLINE_SIZE - 1);
+
+	xSemaphoreTakeRecursive(pxContext->xMutex, portMAX_DELAY);
+	if(prvSpansionSPI_IsChipEraseInProgress(pxContext))
+	{
+		xSemaphoreGiveRecursive(pxContext->xMutex);
+		return(pdFAIL);
+	}
+	traceSPI_FLASH_DISCARD(spansionTRACE_AREA_DATA, ulSectorNumber, ulSectorCount);
+	if(xFirst < xEnd)
+	{
+		prvSpansionSPI_DiscardCache(pxContext, xFirst, xEnd - xFirst);
+	}
+	xSemaphoreGiveRecursive(pxContext->xMutex);
+
+#if(cacheSPI_DISCARD_ENABLE)
+	if((xFirst < xEnd) && (pxContext->xWriteback.Task != NULL))
+	{
+		xTaskNotifyGive(pxContext->xWriteback.Task);
+	}
+#endif
+	return(pdPASS);
+}
+
+/**
+ * @fn BaseType_t xSpansionSPI_DiscardFreeClusters(FF_Disk_t *pxDisk)
+ * @brief Discards every free cluster of the mounted partition (xSpansionSPI_Discard()), e.g. after
+ * files have been deleted. The FAT is locked while it is scanned.
+ * @param pxDisk SPI disk.
+ * @return pdPASS on success.
+ */
+BaseType_t xSpansionSPI_DiscardFreeClusters(FF_Disk_t *pxDisk)
+{
+	FF_IOManager_t *pxIOManager;
+	FF_Error_t xError = FF_ERR_NONE;
+	uint32_t ulCluster, ulEntry, ulFirst = 0, ulCount = 0, ulEnd;
+	BaseType_t xReturn = pdPASS;
+
+	if(pxDisk == NULL || pxDisk->pxIOManager == NULL || pxDisk->xStatus.bIsMounted == pdFALSE)
+	{
+		return(pdFAIL);
+	}
+	pxIOManager = pxDisk->pxIOManager;
+
+	/* Clusters freed in the buffers of the IO manager are written to the FAT first. */
+	if(FF_isERR(FF_FlushCache(pxIOManager)))
+	{
+		return(pdFAIL);
+	}
+
+	FF_LockFAT(pxIOManager);
+	ulEnd = pxIOManager->xPartition.ulNumClusters + 2;
+	for(ulCluster = 2; ulCluster <= ulEnd; ulCluster++)
+	{
+		ulEntry = (ulCluster < ulEnd) ? FF_getFATEntry(pxIOManager, ulCluster, &xError, NULL) : 1;
+		if(FF_isERR(xError))
+		{
+			xReturn = pdFAIL;
+			break;
+		}
+		if(ulEntry == 0)
+		{
+			/* Free clusters are discarded in runs. */
+			if(ulCount++ == 0)
+			{
+				ulFirst = ulCluster;
+			}
+		}
+		else if(ulCount != 0)
+		{
+			xReturn = xSpansionSPI_Discard(pxDisk, FF_Cluster2LBA(pxIOManager, ulFirst), ulCount * pxIOManager->xPartition.ulSectorsPerCluster);
+			ulCount = 0;
+			if(xReturn != pdPASS)
+			{
+				break;
+			}
+		}
+	}
+	FF_UnlockFAT(pxIOManager);
+	return(xReturn);
+}
+
+/**
+ * @fn void vSpansionSPI_GetStats(FF_Disk_t *pxDisk, spansion_stats_t *pxStats)
+ * @brief Copies a consistent snapshot of the cache and device statistics of the disk.
+ * @param pxDisk SPI disk.
+ * @param pxStats destination.
+ */
+void vSpansionSPI_GetStats(FF_Disk_t *pxDisk, spansion_stats_t *pxStats)
+{
+	spansion_context_t *pxContext = (spansion_context_t *)pxDisk->pvTag;
+	uint8_t ucArea;
+
+	xSemaphoreTakeRecursive(pxContext->xMutex, portMAX_DELAY);
+	*pxStats = pxContext->xStats;
+	xSemaphoreGiveRecursive(pxContext->xMutex);
+
+	for(ucArea = 0; ucArea < cacheAREA_COUNT; ucArea++)
+	{
+		pxStats->Area[ucArea].Hits = pxStats->Area[ucArea].ReadHits + pxStats->Area[ucArea].WriteHits;
+		pxStats->Area[ucArea].Misses = pxStats->Area[ucArea].ReadMisses + pxStats->Area[ucArea].WriteMisses;
+	}
+}
+
+/**
+ * @fn UBaseType_t uxSpansionSPI_TraceDrain(FF_Disk_t *pxDisk, spansion_trace_event_t *pxEvents, UBaseType_t uxMaxEvents)
+ * @brief Takes the oldest events from the trace ring of the disk. Doesn't block, doesn't take
+ * the disk mutex, only one task may drain a disk.
+ * @param pxDisk SPI disk.
+ * @param pxEvents destination.
+ * @param uxMaxEvents size of the destination.
+ * @return number of events copied (0 if the trace ring is disabled).
+ */
+UBaseType_t uxSpansionSPI_TraceDrain(FF_Disk_t *pxDisk, spansion_trace_event_t *pxEvents, UBaseType_t uxMaxEvents)
+{
+#if(spansionTRACE_RING_SIZE > 0)
+	spansion_context_t *pxContext = (spansion_context_t *)pxDisk->pvTag;
+
+	return(prvSpansionSPI_TraceDrain(&pxContext->xTrace, pxEvents, uxMaxEvents));
+#else
+	(void)pxDisk;
+	(void)pxEvents;
+	(void)uxMaxEvents;
+	return(0);
+#endif
+}
+
+/**
+ * @fn void vSpansionSPI_ResetStats(FF_Disk_t *pxDisk)
+ * @brief Clears the cache and device statistics of the disk.
+ * @param pxDisk SPI disk.
+ */
+void vSpansionSPI_ResetStats(FF_Disk_t *pxDisk)
+{
+	spansion_context_t *pxContext = (spansion_context_t *)pxDisk->pvTag;
+
+	xSemaphoreTakeRecursive(pxContext->xMutex, portMAX_DELAY);
+	memset(&pxContext->xStats, 0, sizeof(pxContext->xStats));
+	xSemaphoreGiveRecursive(pxContext->xMutex);
+}
+
+/**
+ * @fn void vSpansionSPI_GetGeometry(FF_Disk_t *pxDisk, spansion_geometry_t *pxGeometry)
+ * @brief Copies the geometry of the chip of the disk found by the low level init (JEDEC ID, SFDP).
+ * @param pxDisk SPI disk.
+ * @param pxGeometry destination.
+ */
+void vSpansionSPI_GetGeometry(FF_Disk_t *pxDisk, spansion_geometry_t *pxGeometry)
+{
+	spansion_context_t *pxContext = (spansion_context_t *)pxDisk->pvTag;
+
+	*pxGeometry = pxContext->xGeometry;
+}
+
+/**
+ * @fn BaseType_t xSpansionSPI_StartWriteback(FF_Disk_t *pxDisk, const cache_writeback_config_t *pxConfig)
+ * @brief Starts (or reconfigures) the background write back task of the cache of the disk.
+ * @param pxDisk SPI disk.
+ * @param pxConfig watermarks, age limit and wake up period.
+ * @return pdPASS on success.
+ */
+BaseType_t xSpansionSPI_StartWriteback(FF_Disk_t *pxDisk, const cache_writeback_config_t *pxConfig)
+{
+	spansion_context_t *pxContext;
+	BaseType_t xReturn = pdPASS;
+
+	if(pxDisk == NULL || pxDisk->pvTag == NULL || pxConfig == NULL || pxConfig->LowWatermark > pxConfig->HighWatermark)
+	{
+		return(pdFAIL);
+	}
+	pxContext = (spansion_context_t *)pxDisk->pvTag;
+
+	/* A running task reads the configuration under the mutex. */
+	xSemaphoreTakeRecursive(pxContext->xMutex, portMAX_DELAY);
+	pxContext->xWriteback.Config = *pxConfig;
+	if(pxContext->xWriteback.Config.Period == 0)
+	{
+		pxContext->xWriteback.Config.Period = 1;
+	}
+	xSemaphoreGiveRecursive(pxContext->xMutex);
+
+	if(pxContext->xWriteback.Task == NULL)
+	{
+		xReturn = xTaskCreate(prvSpansionSPI_WritebackTask, "SPIWB", cacheSPI_WRITEBACK_TASK_STACK_SIZE,
+				(void *)pxContext, cacheSPI_WRITEBACK_TASK_PRIORITY, &pxContext->xWriteback.Task);
+		pxContext->xWriteback.Status.Running = (xReturn == pdPASS) ? pdTRUE : pdFALSE;
+	}
+	else
+	{
+		xTaskNotifyGive(pxContext->xWriteback.Task);
+	}
+	return(xReturn);
+}
+
+/**
+ * @fn void vSpansionSPI_GetWritebackStatus(FF_Disk_t *pxDisk, cache_writeback_status_t *pxStatus)
+ * @brief Copies the status of the background write back task of the disk.
+ * @param pxDisk SPI disk.
+ * @param pxStatus destination.
+ */
+void vSpansionSPI_GetWritebackStatus(FF_Disk_t *pxDisk, cache_writeback_status_t *pxStatus)
+{
+	spansion_context_t *pxContext = (spansion_context_t *)pxDisk->pvTag;
+
+	*pxStatus = pxContext->xWriteback.Status;
+	pxStatus->DirtyLines = pxContext->xCacheDirty.Count;
+}
+
+/**
+ * @fn BaseType_t xSpansionSPI_IsChipEraseInProgress(FF_Disk_t *pxDisk)
+ * @brief Check if the chip erase is being in progress.
+ * @param pxDisk SPI disk.
+ * @return pdTRUE in case of device is busy
+ */
+BaseType_t xSpansionSPI_IsChipEraseInProgress(FF_Disk_t *pxDisk)
+{
+	spansion_context_t *pxContext = (spansion_context_t *)pxDisk->pvTag;
+	BaseType_t xReturn;
+
+	xSemaphoreTakeRecursive(pxContext->xMutex, portMAX_DELAY);
+	xReturn = prvSpansionSPI_IsChipEraseInProgress(pxContext);
+	xSemaphoreGiveRecursive(pxContext->xMutex);
+
+	return(xReturn);
+}
+
+/**
+ * @fn void vSpansionSPI_ChipErase(FF_Disk_t *pxDisk)
+ * @brief Public wrapper for prvSpansionSPI_ChipErase() function. The cache is dropped without
+ * write back and every sector becomes known erased: the following writes need neither read nor
+ * erase, vSpansionSPI_PartitionAndFormatDisk() doesn't erase the chip again. The buffers of the
+ * IOManager are not touched, the disk is to be formatted.
+ * @param pxDisk SPI disk.
+ */
+void vSpansionSPI_ChipErase(FF_Disk_t *pxDisk)
+{
+	spansion_context_t *pxContext = (spansion_context_t *)pxDisk->pvTag;
+
+	xSemaphoreTakeRecursive(pxContext->xMutex, portMAX_DELAY);
+	prvSpansionSPI_DropCache(pxContext);
+	prvSpansionSPI_ChipErase(pxContext);
+#if(spansionFTL_LOG_SECTORS > 0)
+	/* The log is erased as well. */
+	prvSpansionSPI_FtlInit(pxContext);
+#endif
+	xSemaphoreGiveRecursive(pxContext->xMutex);
+}
+
+/**
+ * @fn static BaseType_t prvSpansionSPI_LowLevelInit(spansion_context_t *pxContext)
+ * @brief Initializes the transport and the cache, identifies the chip and mounts the log
+ * of the flash translation layer. The default disk fills the chip (without the log).
+ * @param pxContext disk context.
+ * @return pdPASS, pdFAIL if the chip is not supported or the disk doesn't fit.
+ */
+static BaseType_t prvSpansionSPI_LowLevelInit(spansion_context_t *pxContext)
+{
+	const spansion_transport_t *pxTransport = pxContext->xConfig.pxTransport;
+	uint32_t ulChipSectors;
+
+	if(pxTransport->fnInit != NULL)
+	{
+		pxTransport->fnInit(pxTransport->pvContext);
+	}
+	prvSpansionSPI_InitCache(pxContext);
+	if(prvSpansionSPI_Probe(pxContext) == pdFAIL)
+	{
+		return(pdFAIL);
+	}
+
+	ulChipSectors = spansionSPI_DISK_SECTOR_COUNT(pxContext->xGeometry.Size);
+	if(pxContext->xConfig.ulSectorCount == 0)
+	{
+		pxContext->xConfig.ulSectorCount = ulChipSectors;
+	}
+	else if(pxContext->xConfig.ulSectorCount > ulChipSectors)
+	{
+		return(pdFAIL);
+	}
+#if(spansionFTL_LOG_SECTORS > 0)
+	/* The map of the log is rebuilt before the first access. */
+	prvSpansionSPI_FtlMount(pxContext);
+#endif
+	return(pdPASS);
+}
+
+#if(cacheSPI_FAST_FORMAT_ENABLE)
+/**
+ * @fn static void prvSpansionSPI_EraseDisk(spansion_context_t *pxContext)
+ * @brief Erases the disk before the fast format and waits for the end of the erase. The sectors
+ * known erased are skipped. The chip is erased in one step if the disk fills it, otherwise a block
+ * with at least cacheSPI_BLOCK_ERASE_MIN_SECTORS sectors to be erased is block erased.
+ * @param pxContext disk context.
+ */
+static void prvSpansionSPI_EraseDisk(spansion_context_t *pxContext)
+{
+	uint32_t xEnd = pxContext->xConfig.ulSectorCount * spansionFAT_SECTOR_SIZE;
+	uint32_t xSpiAddress, xBlock, xBlockEnd;
+	uint32_t ulSectors = 0;
+
+	prvSpansionSPI_DropCache(pxContext);
+
+	/* A chip erase started before (vSpansionSPI_ChipErase()) ends first. */
+	prvSpansionSPI_WaitReady(pxContext, pdTRUE);
+	pxContext->xPending.Operation = spansionSPI_OP_NONE;
+	pxContext->xChipEraseInProgress = pdFALSE;
+
+	for(xSpiAddress = 0; xSpiAddress < xEnd; xSpiAddress += spansionSPI_SECTOR_SIZE)
+	{
+		if(!cacheIS_ERASED(pxContext, xSpiAddress))
+		{
+			ulSectors++;
+		}
+	}
+	if(ulSectors == 0)
+	{
+		return;
+	}
+
+	if(pxContext->xConfig.ulSectorCount >= spansionSPI_DISK_SECTOR_COUNT(pxContext->xGeometry.Size))
+	{
+		/* The disk fills the chip, the log of the flash translation layer is erased as well. */
+		prvSpansionSPI_ChipErase(pxContext);
+		prvSpansionSPI_WaitReady(pxContext, pdTRUE);
+		pxContext->xChipEraseInProgress = pdFALSE;
+#if(spansionFTL_LOG_SECTORS > 0)
+		prvSpansionSPI_FtlInit(pxContext);
+#endif
+		return;
+	}
+
+	for(xBlock = 0; xBlock < xEnd; xBlock = xBlockEnd)
+	{
+		xBlockEnd = xBlock + spansionSPI_BLOCK_SIZE;
+		ulSectors = 0;
+		for(xSpiAddress = xBlock; (xSpiAddress < xBlockEnd) && (xSpiAddress < xEnd); xSpiAddress += spansionSPI_SECTOR_SIZE)
+		{
+			if(!cacheIS_ERASED(pxContext, xSpiAddress))
+			{
+				ulSectors++;
+			}
+		}
+#if(cacheSPI_BLOCK_ERASE_MIN_SECTORS > 0)
+		if((xBlockEnd <= xEnd) && (ulSectors >= cacheSPI_BLOCK_ERASE_MIN_SECTORS))
+		{
+			prvSpansionSPI_BlockErase(pxContext, xBlock);
+			continue;
+		}
+#endif
+		for(xSpiAddress = xBlock; (ulSectors > 0) && (xSpiAddress < xBlockEnd) && (xSpiAddress < xEnd); xSpiAddress += spansionSPI_SECTOR_SIZE)
+		{
+			if(!cacheIS_ERASED(pxContext, xSpiAddress))
+			{
+				prvSpansionSPI_SectorErase(pxContext, xSpiAddress);
+				ulSectors--;
+			}
+		}
+	}
+}
+#endif
@@ -0,0 +1,317 @@
+/**
+ * @file ma_spansion_s25fl1xxk_cache_replay.c
+ *
+ * @brief Host trace replay of the Spansion S25FL1xxk driver cache.
+ * Replays a recorded FFRead / FFWrite trace (R,F,<sector>,<count>, lines of the trace
+ * decoder or of the former vLoggingPrintf() trace macros) through the driver built with
+ * the host simulator port, and prints one CSV line with the cache configuration, the
+ * hit rates, the program / erase counts and the device time of the replay. The cache
+ * geometry is fixed at compile time, ma_spansion_s25fl1xxk_cache_sweep.sh builds and
+ * runs the replay for a set of configurations.
+ *
+ * The disk is formatted first (the FAT area is the same as on the target with the same
+ * chip size, spansionSPI_SECTOR_COUNT of the simulator), then the statistics are reset. Written sectors get a new
+ * pattern every time, so the program / erase counts are an upper bound. The device time
+ * is the virtual time of the simulator (SPI bus and busy time), the final write back of
+ * the cache included.
+ *
+ * Discard lines (T,<area>,<sector>,<count>,) are passed to xSpansionSPI_Discard(). The
+ * replay does not run the write back task, so the discarded lines are dropped from the
+ * cache and queued, but not pre-erased.
+ *
+ * Build (FreeRTOS kernel POSIX port and FreeRTOS+FAT sources are needed):
+ *   gcc -DspansionSPI_PORT=spansionSPI_PORT_HOST_SIMULATOR [-DcacheSPI_CACHE_SIZE=n ...]
+ *       -I<driver>/include -I<driver> -I<FreeRTOS+FAT>/include -I<FreeRTOS>/include
+ *       -I<FreeRTOS>/portable/ThirdParty/GCC/Posix -I<config dir>
+ *       <driver>/ma_spansion_s25flxxk.c <driver>/tools/ma_spansion_s25fl1xxk_cache_replay.c
+ *       <FreeRTOS+FAT sources> <FreeRTOS kernel sources> -lpthread -o spansion_cache_replay
+ *
+ * Usage: spansion_cache_replay [-H] [-c spi_clock_Hz] [trace_file]
+ *   -H prints the CSV header only.
+ *
+ * @author Lovas Szilárd <lovas.szilard@gmail.com>
+ * @version: 0.6
+ * @date: 2017-08-07 10:00
+ * - initial version
+ * @date: 2017-08-14 10:00
+ * - 0.2 Flash translation layer columns.
+ * @date: 2017-08-21 10:00
+ * - 0.3 Discard requests, discard columns.
+ * @date: 2017-09-04 10:00
+ * - 0.4 Partial line fill columns.
+ * @date: 2017-09-11 10:00
+ * - 0.5 cache_size: the entries of the cache, the lines of the unified buffering included.
+ * @date: 2017-09-25 10:00
+ * - 0.6 Replacement policy columns.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* FreeRTOS+FAT includes. */
+#include "ff_headers.h"
+
+#include "ma_spansion_s25fl1xxk.h"
+#include "ma_spansion_s25fl1xxk_simulator.h"
+
+#define replayDISK_NAME				"/spi"
+#define replayMAX_SECTORS			128			/* Longest request [FAT sectors]. */
+#define replayTASK_STACK_SIZE		(configMINIMAL_STACK_SIZE * 8)
+#define replayLINE_LENGTH			128
+
+#define replayHEADER	"cache_size,fat_reserved,line_size,victim_scan,requests,area_mismatches," \
+						"fat_hit_rate,data_hit_rate,fat_hits,fat_misses,data_hits,data_misses," \
+						"streamed_sectors,bulk_sectors,write_backs,block_flushes," \
+						"page_programs,sector_erases,block_erases,read_bytes,device_ms,busy_ms," \
+						"ftl_log_sectors,ftl_records,ftl_collections,discarded_lines,erased_fills," \
+						"partial_fill,partial_fills,partial_fill_sectors," \
+						"policy,promotions,ghost_hits,partition_moves\n"
+
+static FILE *pxTraceFile;
+static uint32_t ulSpiClock = spansionSIM_SPI_CLOCK_HZ;
+static uint8_t ucBuffer[replayMAX_SECTORS * spansionFAT_SECTOR_SIZE];
+
+static void prvReplayTask(void *pvParameters);
+static int32_t prvReplayRequest(FF_Disk_t *pxDisk, char cOp, uint32_t ulSector, uint32_t ulCount, uint32_t ulSeed);
+static BaseType_t prvIsFatSector(FF_Disk_t *pxDisk, uint32_t ulSector);
+static double prvHitRate(const cache_stats_t *pxStats);
+
+/**
+ * @fn void vLoggingPrintf(const char *pcFormat, ...)
+ * @brief Sink of the FreeRTOS+FAT messages (stderr).
+ */
+void vLoggingPrintf(const char *pcFormat, ...)
+{
+	va_list xArgs;
+
+	va_start(xArgs, pcFormat);
+	vfprintf(stderr, pcFormat, xArgs);
+	va_end(xArgs);
+}
+
+int main(int argc, char **argv)
+{
+	int iOption;
+
+	while((iOption = getopt(argc, argv, "Hc:")) != -1)
+	{
+		switch(iOption)
+		{
+			case 'H':
+				printf(replayHEADER);
+				return(EXIT_SUCCESS);
+			case 'c':
+				ulSpiClock = (uint32_t)strtoul(optarg, NULL, 0);
+				break;
+			default:
+				fprintf(stderr, "usage: %s [-H] [-c spi_clock_Hz] [trace_file]\n", argv[0]);
+				return(EXIT_FAILURE);
+		}
+	}
+
+	pxTraceFile = stdin;
+	if(optind < argc)
+	{
+		pxTraceFile = fopen(argv[optind], "r");
+		if(pxTraceFile == NULL)
+		{
+			perror(argv[optind]);
+			return(EXIT_FAILURE);
+		}
+	}
+
+	if(xSpansionSim_Open(0, NULL) != pdPASS)
+	{
+		fprintf(stderr, "Can not open the flash simulator.\n");
+		return(EXIT_FAILURE);
+	}
+	vSpansionSim_SetSpiClock(ulSpiClock);
+
+	xTaskCreate(prvReplayTask, "replay", replayTASK_STACK_SIZE, NULL, tskIDLE_PRIORITY + 1, NULL);
+	vTaskStartScheduler();
+
+	return(EXIT_FAILURE);
+}
+
+/**
+ * @fn static void prvReplayTask(void *pvParameters)
+ * @brief Formats the emulated disk, replays the trace and prints the result line.
+ */
+static void prvReplayTask(void *pvParameters)
+{
+	FF_Disk_t *pxDisk;
+	spansion_stats_t xStats;
+	spansion_sim_stats_t xSimStats;
+	char cLine[replayLINE_LENGTH];
+	char cOp, cArea;
+	unsigned uSector, uCount;
+	uint32_t ulRequests = 0, ulMismatches = 0;
+	uint64_t ullStart;
+
+	(void)pvParameters;
+
+	pxDisk = FF_SPIDiskInit(replayDISK_NAME, pdTRUE);
+	if(pxDisk == NULL)
+	{
+		fprintf(stderr, "FF_SPIDiskInit failed.\n");
+		exit(EXIT_FAILURE);
+	}
+	FF_FlushCache(pxDisk->pxIOManager);
+	while(xSpansionSPI_SyncCache(pxDisk, 0) != pdTRUE);
+
+	vSpansionSPI_ResetStats(pxDisk);
+	vSpansionSim_ResetStats(0);
+	ullStart = xGetHighResolutionTime();
+
+	while(fgets(cLine, sizeof(cLine), pxTraceFile) != NULL)
+	{
+		if(sscanf(cLine, "%c,%c,%u,%u", &cOp, &cArea, &uSector, &uCount) != 4)
+		{
+			continue;
+		}
+		if(((cOp != 'R') && (cOp != 'W') && (cOp != 'T')) || (uCount == 0))
+		{
+			continue;
+		}
+		if(cOp == 'T')
+		{
+			/* The driver rounds the range to whole lines and checks it. */
+			(void)xSpansionSPI_Discard(pxDisk, uSector, uCount);
+			ulRequests++;
+			continue;
+		}
+		if(prvIsFatSector(pxDisk, uSector) != (cArea == 'F'))
+		{
+			ulMismatches++;
+		}
+		if(prvReplayRequest(pxDisk, cOp, uSector, uCount, ulRequests) != 0)
+		{
+			fprintf(stderr, "%c,%c,%u,%u: request failed.\n", cOp, cArea, uSector, uCount);
+			exit(EXIT_FAILURE);
+		}
+		ulRequests++;
+	}
+
+	/* Write back what is left in the cache. */
+	while(xSpansionSPI_SyncCache(pxDisk, 0) != pdTRUE);
+
+	vSpansionSPI_GetStats(pxDisk, &xStats);
+	vSpansionSim_GetStats(0, &xSimStats);
+
+	printf("%u,%u,%u,%u,%u,%u,%.2f,%.2f,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%.1f,%.1f,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u\n",
+			(unsigned)cacheLINE_COUNT,
+			(unsigned)cacheSPI_CACHE_FAT_RESERVED_SIZE,
+			(unsigned)cacheLINE_SIZE,
+			(unsigned)cacheSPI_CLEAN_VICTIM_SCAN,
+			(unsigned)ulRequests,
+			(unsigned)ulMismatches,
+			prvHitRate(&xStats.Area[cacheAREA_FAT]),
+			prvHitRate(&xStats.Area[cacheAREA_DATA]),
+			(unsigned)xStats.Area[cacheAREA_FAT].Hits,
+			(unsigned)xStats.Area[cacheAREA_FAT].Misses,
+			(unsigned)xStats.Area[cacheAREA_DATA].Hits,
+			(unsigned)xStats.Area[cacheAREA_DATA].Misses,
+			(unsigned)(xStats.Area[cacheAREA_FAT].StreamedSectors + xStats.Area[cacheAREA_DATA].StreamedSectors),
+			(unsigned)(xStats.Area[cacheAREA_FAT].BulkSectors + xStats.Area[cacheAREA_DATA].BulkSectors),
+			(unsigned)xStats.WriteBacks,
+			(unsigned)xStats.BlockFlushes,
+			(unsigned)xSimStats.ulPagePrograms,
+			(unsigned)xSimStats.ulSectorErases,
+			(unsigned)xSimStats.ulBlockErases,
+			(unsigned)xSimStats.ulReadBytes,
+			(double)(xGetHighResolutionTime() - ullStart) / 1000.0,
+			(double)xSimStats.ullBusyTime / 1000.0,
+			(unsigned)spansionFTL_LOG_SECTORS,
+			(unsigned)xStats.FtlRecords,
+			(unsigned)xStats.FtlCollections,
+			(unsigned)xStats.DiscardedLines,
+			(unsigned)xStats.ErasedFills,
+			(unsigned)cacheSPI_PARTIAL_FILL_ENABLE,
+			(unsigned)xStats.PartialFills,
+			(unsigned)xStats.PartialFillSectors,
+			(unsigned)cacheSPI_REPLACEMENT_POLICY,
+			(unsigned)xStats.Promotions,
+			(unsigned)xStats.GhostHits,
+			(unsigned)xStats.PartitionMoves);
+	fflush(stdout);
+
+	if(ulMismatches != 0)
+	{
+		fprintf(stderr, "# %u requests are in another area than in the trace (FAT geometry differs).\n", (unsigned)ulMismatches);
+	}
+	if(pxTraceFile != stdin)
+	{
+		fclose(pxTraceFile);
+	}
+	vSpansionSim_Close(0);
+	exit(EXIT_SUCCESS);
+}
+
+/**
+ * @fn static int32_t prvReplayRequest(FF_Disk_t *pxDisk, char cOp, uint32_t ulSector, uint32_t ulCount, uint32_t ulSeed)
+ * @brief Issues one traced request on the block device interface of the disk.
+ * Longer requests are split into replayMAX_SECTORS pieces, written sectors get a
+ * pattern depending on the request number.
+ * @return 0 or the FreeRTOS+FAT error code.
+ */
+static int32_t prvReplayRequest(FF_Disk_t *pxDisk, char cOp, uint32_t ulSector, uint32_t ulCount, uint32_t ulSeed)
+{
+	uint32_t ulLength, i;
+	int32_t lResult = 0;
+
+	while((ulCount > 0) && (lResult == 0))
+	{
+		ulLength = (ulCount > replayMAX_SECTORS) ? replayMAX_SECTORS : ulCount;
+		if(cOp == 'W')
+		{
+			for(i = 0; i < ulLength * spansionFAT_SECTOR_SIZE; i++)
+			{
+				ucBuffer[i] = (uint8_t)((i * 31) >> 3) ^ (uint8_t)(ulSeed * 17 + 1);
+			}
+		}
+		do
+		{
+			if(cOp == 'W')
+			{
+				lResult = pxDisk->pxIOManager->xBlkDevice.fnpWriteBlocks(ucBuffer, ulSector, ulLength, pxDisk);
+			}
+			else
+			{
+				lResult = pxDisk->pxIOManager->xBlkDevice.fnpReadBlocks(ucBuffer, ulSector, ulLength, pxDisk);
+			}
+		} while(lResult == FF_ERR_DRIVER_BUSY);
+		ulSector += ulLength;
+		ulCount -= ulLength;
+	}
+
+	return(lResult);
+}
+
+/**
+ * @fn static BaseType_t prvIsFatSector(FF_Disk_t *pxDisk, uint32_t ulSector)
+ * @brief Area of a sector on the replay disk (the partition selection of the driver).
+ */
+static BaseType_t prvIsFatSector(FF_Disk_t *pxDisk, uint32_t ulSector)
+{
+	uint32_t ulFirst = pxDisk->pxIOManager->xPartition.ulFATBeginLBA;
+	uint32_t ulLast = ulFirst + pxDisk->pxIOManager->xPartition.ulSectorsPerFAT * (uint32_t)pxDisk->pxIOManager->xPartition.ucNumFATS;
+
+	return((ulSector >= ulFirst) && (ulSector < ulLast));
+}
+
+/**
+ * @fn static double prvHitRate(const cache_stats_t *pxStats)
+ * @brief Hit rate of an area [%].
+ */
+static double prvHitRate(const cache_stats_t *pxStats)
+{
+	uint32_t ulTotal = pxStats->Hits + pxStats->Misses;
+
+	return((ulTotal != 0) ? (100.0 * pxStats->Hits) / ulTotal : 0.0);
+}
@@ -0,0 +1,90 @@
+#!/bin/sh
+#
+# @file ma_spansion_s25fl1xxk_cache_sweep.sh
+#
+# @brief Replays a trace with every combination of the cache parameters below and
+# prints the result lines of ma_spansion_s25fl1xxk_cache_replay.c as one CSV table.
+# The cache geometry is a compile time setting of the driver, so the replay is built
+# once per configuration.
+#
+# Usage: SPANSION_REPLAY_CFLAGS="-I... -I..." SPANSION_REPLAY_SOURCES="<FreeRTOS+FAT and kernel sources>"
+#        ma_spansion_s25fl1xxk_cache_sweep.sh trace_file [spi_clock_Hz] > results.csv
+#
+# The swept values can be overridden from the environment:
+#   SWEEP_CACHE_SIZES		cacheSPI_CACHE_SIZE
+#   SWEEP_FAT_RESERVED		cacheSPI_CACHE_FAT_RESERVED_SIZE (values >= the cache size are skipped)
+#   SWEEP_VICTIM_SCANS		cacheSPI_CLEAN_VICTIM_SCAN (0: plain LRU, n: clean entries among the n LRU ones first)
+#   SWEEP_FTL_LOG_SECTORS	spansionFTL_LOG_SECTORS (0: no flash translation layer)
+#   SWEEP_PARTIAL_FILL		cacheSPI_PARTIAL_FILL_ENABLE (0: whole line fills)
+#   SWEEP_POLICY		cacheSPI_REPLACEMENT_POLICY (0: LRU, 1: adaptive)
+# The line size is the 4 kB erase sector of the chip, it is reported but not swept.
+#
+# @author Lovas Szilárd <lovas.szilard@gmail.com>
+# @version: 0.4
+# @date: 2017-08-07 10:00
+# - initial version
+# @date: 2017-08-14 10:00
+# - 0.2 SWEEP_FTL_LOG_SECTORS
+# @date: 2017-09-04 10:00
+# - 0.3 SWEEP_PARTIAL_FILL
+# @date: 2017-09-25 10:00
+# - 0.4 SWEEP_POLICY
+
+set -e
+
+TRACE=$1
+CLOCK=${2:-5000000}
+DRIVER=$(cd "$(dirname "$0")/.." && pwd)
+BUILD=${TMPDIR:-/tmp}/spansion_cache_sweep.$$
+CC=${CC:-gcc}
+
+SWEEP_CACHE_SIZES=${SWEEP_CACHE_SIZES:-"2 4 8 16 32"}
+SWEEP_FAT_RESERVED=${SWEEP_FAT_RESERVED:-"0 1 2 4 8"}
+SWEEP_VICTIM_SCANS=${SWEEP_VICTIM_SCANS:-"0 4"}
+SWEEP_FTL_LOG_SECTORS=${SWEEP_FTL_LOG_SECTORS:-"0"}
+SWEEP_PARTIAL_FILL=${SWEEP_PARTIAL_FILL:-"1"}
+SWEEP_POLICY=${SWEEP_POLICY:-"0 1"}
+
+if [ -z "$TRACE" ] || [ ! -r "$TRACE" ]; then
+	echo "usage: $0 trace_file [spi_clock_Hz]" >&2
+	exit 1
+fi
+
+mkdir -p "$BUILD"
+trap 'rm -rf "$BUILD"' EXIT
+
+HEADER=1
+for SIZE in $SWEEP_CACHE_SIZES; do
+	# Tag hash: the smallest power of two not less than the cache size.
+	HASH=1
+	while [ $HASH -lt $SIZE ]; do
+		HASH=$((HASH * 2))
+	done
+	for FAT in $SWEEP_FAT_RESERVED; do
+		if [ $FAT -ge $SIZE ]; then
+			continue
+		fi
+		for SCAN in $SWEEP_VICTIM_SCANS; do
+			for LOG in $SWEEP_FTL_LOG_SECTORS; do
+				for PARTIAL in $SWEEP_PARTIAL_FILL; do
+					for POLICY in $SWEEP_POLICY; do
+						$CC -O2 -w -DspansionSPI_PORT=spansionSPI_PORT_HOST_SIMULATOR \
+							-DcacheSPI_CACHE_SIZE=$SIZE -DcacheSPI_CACHE_FAT_RESERVED_SIZE=$FAT \
+							-DcacheSPI_HASH_SIZE=$HASH -DcacheSPI_CLEAN_VICTIM_SCAN=$SCAN \
+							-DspansionFTL_LOG_SECTORS=$LOG -DcacheSPI_PARTIAL_FILL_ENABLE=$PARTIAL \
+							-DcacheSPI_REPLACEMENT_POLICY=$POLICY \
+							-I"$DRIVER/include" -I"$DRIVER" $SPANSION_REPLAY_CFLAGS \
+							"$DRIVER/ma_spansion_s25flxxk.c" "$DRIVER/tools/ma_spansion_s25fl1xxk_cache_replay.c" \
+							$SPANSION_REPLAY_SOURCES -lpthread -o "$BUILD/replay"
+						if [ $HEADER -ne 0 ]; then
+							"$BUILD/replay" -H
+							HEADER=0
+						fi
+						# Only the result line, FF_PRINTF() may also go to stdout.
+						"$BUILD/replay" -c $CLOCK "$TRACE" | grep -E '^[0-9]+,'
+					done
+				done
+			done
+		done
+	done
+done
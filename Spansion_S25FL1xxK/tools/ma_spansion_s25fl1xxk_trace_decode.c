@@ -0,0 +1,154 @@
+/**
+ * @file ma_spansion_s25fl1xxk_trace_decode.c
+ *
+ * @brief Host decoder of the binary trace of the Spansion S25FL1xxk driver.
+ * Reads the spansion_trace_event_t records drained by uxSpansionSPI_TraceDrain()
+ * and prints them in the CSV format of the former vLoggingPrintf() trace macros:
+ *   <R|W|T>,<F|D>,<sector>,<count>,
+ * (T: xSpansionSPI_Discard() request, whole 4 kB sectors),
+ * -t appends the event time [us] (extended to 64 bits over the 32 bit wraps),
+ * -B reads records written by a big endian target (TMS570).
+ * Lost events (the ring was full) are reported on stderr.
+ *
+ * Build: gcc -o spansion_trace_decode ma_spansion_s25fl1xxk_trace_decode.c
+ * Usage: spansion_trace_decode [-t] [-B] [trace_file]
+ *
+ * @author Lovas Szilárd <lovas.szilard@gmail.com>
+ * @version: 0.2
+ * @date: 2017-07-31 10:00
+ * - initial version
+ * @date: 2017-08-21 10:00
+ * - 0.2 Discard events.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <unistd.h>
+
+/* Record layout of spansion_trace_event_t. */
+#define decodeRECORD_SIZE		12
+#define decodeOFFSET_TIME		0
+#define decodeOFFSET_SECTOR		4
+#define decodeOFFSET_COUNT		8
+#define decodeOFFSET_OP			10
+#define decodeOFFSET_AREA		11
+
+#define decodeOP_READ			'R'
+#define decodeOP_WRITE			'W'
+#define decodeOP_DISCARD		'T'
+#define decodeOP_LOST			'L'
+
+static int iBigEndian = 0;
+
+static uint32_t prvGet32(const uint8_t *pucData);
+static uint16_t prvGet16(const uint8_t *pucData);
+
+int main(int argc, char **argv)
+{
+	uint8_t ucRecord[decodeRECORD_SIZE];
+	FILE *pxFile = stdin;
+	int iTime = 0;
+	int iOption;
+	uint64_t ullTime = 0;
+	uint32_t ulLastTime = 0;
+	unsigned long ulEvents = 0;
+	unsigned long ulLost = 0;
+
+	while((iOption = getopt(argc, argv, "tB")) != -1)
+	{
+		switch(iOption)
+		{
+			case 't':
+				iTime = 1;
+				break;
+			case 'B':
+				iBigEndian = 1;
+				break;
+			default:
+				fprintf(stderr, "usage: %s [-t] [-B] [trace_file]\n", argv[0]);
+				return(EXIT_FAILURE);
+		}
+	}
+	if(optind < argc)
+	{
+		pxFile = fopen(argv[optind], "rb");
+		if(pxFile == NULL)
+		{
+			perror(argv[optind]);
+			return(EXIT_FAILURE);
+		}
+	}
+
+	while(fread(ucRecord, decodeRECORD_SIZE, 1, pxFile) == 1)
+	{
+		uint32_t ulTime = prvGet32(&ucRecord[decodeOFFSET_TIME]);
+		uint32_t ulSector = prvGet32(&ucRecord[decodeOFFSET_SECTOR]);
+		uint16_t usCount = prvGet16(&ucRecord[decodeOFFSET_COUNT]);
+		uint8_t ucOp = ucRecord[decodeOFFSET_OP];
+		uint8_t ucArea = ucRecord[decodeOFFSET_AREA];
+
+		/* The events are in time order, a smaller time is a wrap of the 32 bit counter. */
+		ullTime += (uint32_t)(ulTime - ulLastTime);
+		ulLastTime = ulTime;
+
+		if(ucOp == decodeOP_LOST)
+		{
+			fprintf(stderr, "# %u events lost at %llu us\n", (unsigned)ulSector, (unsigned long long)ullTime);
+			ulLost += ulSector;
+			continue;
+		}
+		if((ucOp != decodeOP_READ) && (ucOp != decodeOP_WRITE) && (ucOp != decodeOP_DISCARD))
+		{
+			fprintf(stderr, "# unknown event 0x%02x at record %lu\n", ucOp, ulEvents);
+			continue;
+		}
+
+		if(iTime)
+		{
+			printf("%c,%c,%u,%u,%llu\n", ucOp, ucArea, (unsigned)ulSector, (unsigned)usCount, (unsigned long long)ullTime);
+		}
+		else
+		{
+			printf("%c,%c,%u,%u,\n", ucOp, ucArea, (unsigned)ulSector, (unsigned)usCount);
+		}
+		ulEvents++;
+	}
+
+	if(ulLost != 0)
+	{
+		fprintf(stderr, "# %lu events decoded, %lu lost\n", ulEvents, ulLost);
+	}
+	if(pxFile != stdin)
+	{
+		fclose(pxFile);
+	}
+
+	return((ulLost != 0) ? 2 : EXIT_SUCCESS);
+}
+
+/**
+ * @fn static uint32_t prvGet32(const uint8_t *pucData)
+ * @brief 32 bit field of a record in the byte order of the target.
+ */
+static uint32_t prvGet32(const uint8_t *pucData)
+{
+	if(iBigEndian)
+	{
+		return(((uint32_t)pucData[0] << 24) | ((uint32_t)pucData[1] << 16) | ((uint32_t)pucData[2] << 8) | pucData[3]);
+	}
+	return(((uint32_t)pucData[3] << 24) | ((uint32_t)pucData[2] << 16) | ((uint32_t)pucData[1] << 8) | pucData[0]);
+}
+
+/**
+ * @fn static uint16_t prvGet16(const uint8_t *pucData)
+ * @brief 16 bit field of a record in the byte order of the target.
+ */
+static uint16_t prvGet16(const uint8_t *pucData)
+{
+	if(iBigEndian)
+	{
+		return((uint16_t)(((uint16_t)pucData[0] << 8) | pucData[1]));
+	}
+	return((uint16_t)(((uint16_t)pucData[1] << 8) | pucData[0]));
+}